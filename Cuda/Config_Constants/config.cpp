@@ -8,6 +8,7 @@
 
 // Constructors uses geneticFileRead() to set the struct's properties from a default config file located in same folder as executable
 cudaConstants::cudaConstants() {
+    setDefaults();
     // Get values from the file
     FileRead("genetic.config");
     // Now that dry_mass and fuel_mass have been acquired, derive wet_mass
@@ -21,6 +22,7 @@ cudaConstants::cudaConstants() {
 
 // Operates same as default, however uses configFile as address for where the config file to be used is located
 cudaConstants::cudaConstants(std::string configFile) {
+    setDefaults();
     // Get values from the file
     FileRead(configFile);
     // Now that dry_mass and fuel_mass have been acquired, derive wet_mass
@@ -32,6 +34,36 @@ cudaConstants::cudaConstants(std::string configFile) {
     this->cpu_numsteps = this->max_numsteps;
 }
 
+// Defaults for values that older config files may not have, used by both constructors before FileRead()
+void cudaConstants::setDefaults() {
+    this->rk_backend = GPU_BACKEND;
+    this->cpu_threads = 0;
+    this->cpu_chunk_size = 4;
+    this->cpu_simd_batch = false;
+    this->thrust_table_tol = 0;
+    this->fitness_cache_size = 65536;
+    this->fitness_cache_tol = 0;
+    this->screen_max_numsteps = 0;
+    this->screen_tol = 0;
+    this->screen_margin = 1.5;
+    this->prune_checkpoints = 0;
+    this->prune_margin = 2;
+    this->kepler_coast = false;
+    this->step_control = SCALE_STEP;
+    this->rk_tableau = DP5_TABLEAU;
+    this->canonical_units = false;
+    this->carry_stage = true;
+    this->verify_count = 0;
+    this->verify_tol = 1e-14;
+    this->verify_numsteps = 20000;
+    this->parareal_slices = 0;
+    this->parareal_coarse_tol = 1e-8;
+    this->earth_mode = TABLE_EARTH;
+    this->earth_ephemeris = "earthEphemeris.bin";
+    this->earth_segments = 1;
+    this->earth_cache = "./";
+}
+
 // http://www.cplusplus.com/forum/beginner/11304/ for refesher on reading line by line
 // Input: fileName - string address to the path to open the file being used
 // Output - variable names found in the file that correspond to the cudaConstants' will be assigned the value followed by the name and '=', following a certain format assumption base (refer to config_readme.md for more precise information on format)
@@ -241,9 +273,142 @@ void cudaConstants::FileRead(std::string fileName) {
                 else if (variableName == "thread_block_size") {
                     this->thread_block_size = std::stoi(variableValue);
                 }
+                else if (variableName == "rk_backend") {
+                    if (variableValue == "CPU") {
+                        this->rk_backend = CPU_BACKEND;
+                    }
+                    else {
+                        // If not set to CPU, then it is assumed the GPU is used
+                        this->rk_backend = GPU_BACKEND;
+                    }
+                }
+                else if (variableName == "cpu_threads") {
+                    this->cpu_threads = std::stoi(variableValue);
+                }
+                else if (variableName == "cpu_chunk_size") {
+                    this->cpu_chunk_size = std::stoi(variableValue);
+                }
+                else if (variableName == "thrust_table_tol") {
+                    this->thrust_table_tol = std::stod(variableValue);
+                }
+                else if (variableName == "fitness_cache_size") {
+                    this->fitness_cache_size = std::stoi(variableValue);
+                }
+                else if (variableName == "fitness_cache_tol") {
+                    this->fitness_cache_tol = std::stod(variableValue);
+                }
+                else if (variableName == "screen_max_numsteps") {
+                    this->screen_max_numsteps = std::stoi(variableValue);
+                }
+                else if (variableName == "screen_tol") {
+                    this->screen_tol = std::stod(variableValue);
+                }
+                else if (variableName == "screen_margin") {
+                    this->screen_margin = std::stod(variableValue);
+                }
+                else if (variableName == "prune_checkpoints") {
+                    this->prune_checkpoints = std::stoi(variableValue);
+                }
+                else if (variableName == "prune_margin") {
+                    this->prune_margin = std::stod(variableValue);
+                }
+                else if (variableName == "kepler_coast") {
+                    if (variableValue == "true") {
+                        this->kepler_coast = true;
+                    }
+                    else {
+                        // If not set to true, then it is assumed the value is false
+                        this->kepler_coast = false;
+                    }
+                }
+                else if (variableName == "step_control") {
+                    if (variableValue == "PI") {
+                        this->step_control = PI_STEP;
+                    }
+                    else {
+                        // If not set to PI, then each step rescales the next as before
+                        this->step_control = SCALE_STEP;
+                    }
+                }
+                else if (variableName == "rk_tableau") {
+                    if (variableValue == "VERNER65") {
+                        this->rk_tableau = VERNER65_TABLEAU;
+                    }
+                    else if (variableValue == "DOP853") {
+                        this->rk_tableau = DOP853_TABLEAU;
+                    }
+                    else {
+                        // If not set to VERNER65 or DOP853, then use the original Dormand-Prince 5(4)
+                        this->rk_tableau = DP5_TABLEAU;
+                    }
+                }
+                else if (variableName == "canonical_units") {
+                    if (variableValue == "true") {
+                        this->canonical_units = true;
+                    }
+                    else {
+                        // If not set to true, then it is assumed the value is false
+                        this->canonical_units = false;
+                    }
+                }
+                else if (variableName == "carry_stage") {
+                    if (variableValue == "false") {
+                        this->carry_stage = false;
+                    }
+                    else {
+                        // If not set to false, then it is assumed the value is true
+                        this->carry_stage = true;
+                    }
+                }
+                else if (variableName == "verify_count") {
+                    this->verify_count = std::stoi(variableValue);
+                }
+                else if (variableName == "verify_tol") {
+                    this->verify_tol = std::stod(variableValue);
+                }
+                else if (variableName == "verify_numsteps") {
+                    this->verify_numsteps = std::stoi(variableValue);
+                }
+                else if (variableName == "parareal_slices") {
+                    this->parareal_slices = std::stoi(variableValue);
+                }
+                else if (variableName == "parareal_coarse_tol") {
+                    this->parareal_coarse_tol = std::stod(variableValue);
+                }
+                else if (variableName == "cpu_simd_batch") {
+                    if (variableValue == "true") {
+                        this->cpu_simd_batch = true;
+                    }
+                    else {
+                        // If not set to true, then it is assumed the value is false
+                        this->cpu_simd_batch = false;
+                    }
+                }
                 else if (variableName == "timeRes") {
                     this->timeRes = std::stoi(variableValue);
                 }
+                else if (variableName == "earth_mode") {
+                    if (variableValue == "KEPLER") {
+                        this->earth_mode = KEPLER_EARTH;
+                    }
+                    else if (variableValue == "EPHEMERIS") {
+                        this->earth_mode = EPHEMERIS_EARTH;
+                    }
+                    else {
+                        // If not set to KEPLER or EPHEMERIS, then it is assumed the table is used
+                        this->earth_mode = TABLE_EARTH;
+                    }
+                }
+                else if (variableName == "earth_ephemeris") {
+                    this->earth_ephemeris = variableValue;
+                }
+                else if (variableName == "earth_segments") {
+                    this->earth_segments = std::stoi(variableValue);
+                }
+                else if (variableName == "earth_cache") {
+                    // Folder for the earth cache files (ending in a slash), or NONE to always calculate the table
+                    this->earth_cache = variableValue;
+                }
                 else if (variableName == "time_seed") { // If the conifguration sets time_seed to NONE then time_seed is set to time(0) 
                     if (variableValue != "NONE") {
                         // If variableValue is not NONE, assumption is that it is a valid double value that can be converted and used
@@ -274,11 +439,17 @@ std::ostream& operator<<(std::ostream& os, const cudaConstants& object) {
     os << "\ttime_seed: "       << object.time_seed       << "\trandom_start: "   << object.random_start   << "\t\tnon_r_start_address: " << object.initial_start_file_address << "\n";
     os << "\tanneal_factor: "   << object.anneal_factor   << "\tanneal_initial: " << object.anneal_initial <<   "\tchange_check: "        << object.change_check << "\n";
     os << "\tnum_individuals: " << object.num_individuals << "\tthread_block_size: "     << object.thread_block_size << "\n";
+    os << "\trk_backend: "      << (object.rk_backend == cudaConstants::CPU_BACKEND ? "CPU" : "GPU") << "\t\tcpu_threads: " << object.cpu_threads << "\tcpu_chunk_size: " << object.cpu_chunk_size << "\tcpu_simd_batch: " << object.cpu_simd_batch << "\tthrust_table_tol: " << object.thrust_table_tol << "\n";
+    os << "\tfitness_cache_size: " << object.fitness_cache_size << "\tfitness_cache_tol: " << object.fitness_cache_tol << "\n";
+    os << "\tscreen_max_numsteps: " << object.screen_max_numsteps << "\tscreen_tol: " << object.screen_tol << "\tscreen_margin: " << object.screen_margin << "\n";
+    os << "\tprune_checkpoints: " << object.prune_checkpoints << "\tprune_margin: " << object.prune_margin << "\n";
     os << "\tsurvivor_count: "  << object.survivor_count  << "\tsurvivorRatio: "    << object.survivorRatio;
     os << "\tbest_count: "      << object.best_count      << "\t\tmax_generations: "<< object.max_generations<< "\trun_count: " << object.run_count << "\n\n";
 
     os << "Runge-Kutta Related Values:\n";
-    os << "\trk_tol: " << object.rk_tol << "\tdoublePrecThresh: " << object.doublePrecThresh << "\ttimeRes: " << object.timeRes << "\tGuessMaxPossibleSteps: " << object.GuessMaxPossibleSteps << "\n";
+    os << "\trk_tol: " << object.rk_tol << "\tdoublePrecThresh: " << object.doublePrecThresh << "\ttimeRes: " << object.timeRes << "\tGuessMaxPossibleSteps: " << object.GuessMaxPossibleSteps << "\tkepler_coast: " << object.kepler_coast << "\tstep_control: " << (object.step_control == cudaConstants::PI_STEP ? "PI" : "SCALE") << "\trk_tableau: " << (object.rk_tableau == cudaConstants::DOP853_TABLEAU ? "DOP853" : (object.rk_tableau == cudaConstants::VERNER65_TABLEAU ? "VERNER65" : "DP5")) << "\tcanonical_units: " << object.canonical_units << "\tcarry_stage: " << object.carry_stage << "\n";
+    os << "\tearth_mode: " << (object.earth_mode == cudaConstants::KEPLER_EARTH ? "KEPLER" : (object.earth_mode == cudaConstants::EPHEMERIS_EARTH ? "EPHEMERIS" : "TABLE")) << "\tearth_ephemeris: " << object.earth_ephemeris << "\tearth_segments: " << object.earth_segments << "\tearth_cache: " << object.earth_cache << "\n";
+    os << "\tverify_count: " << object.verify_count << "\tverify_tol: " << object.verify_tol << "\tverify_numsteps: " << object.verify_numsteps << "\tparareal_slices: " << object.parareal_slices << "\tparareal_coarse_tol: " << object.parareal_coarse_tol << "\n";
     os << "\tmax_numsteps: " << object.max_numsteps << "\tmin_numsteps: "  << object.min_numsteps << "\tcpu_numsteps: " << object.cpu_numsteps << "\n\n";
 
     os << "Output Variables:\n";
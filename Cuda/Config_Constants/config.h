@@ -80,15 +80,42 @@ struct cudaConstants {
     double rk_tol;       // The relative/absolute (not sure which one it is) tolerance for the runge kutta algorithm
     double doublePrecThresh; // The smallest allowed double value for runge-kutta
     int GuessMaxPossibleSteps; // Used as a large value to ensure adequate memory allocation in the arrays that record information in rk4sys() in output.cpp
-    int cpu_numsteps;    // Constant higher precision for final CPU RK method, set to be equal to max_numsteps
+    int cpu_numsteps;    // Number of even intervals trajectoryPrint() samples the final trajectory at, set to be equal to max_numsteps
     int min_numsteps;    // Minimum number of steps in runge kutta 
     int max_numsteps;    // Maximum number of steps in runge kutta 
     int num_individuals; // Number of individuals in the pool, each individual contains its own thread
     int survivor_count;  // Number of survivors selected, every pair of survivors creates 8 new individuals
     int thread_block_size;
 
+    int rk_backend;  // Which backend evaluates the individuals each generation, GPU_BACKEND (callRK) or CPU_BACKEND (callRKCPU), set in the config as GPU or CPU
+    int cpu_threads; // Number of CPU threads used by the CPU backend and to make each new generation, 0 uses one thread per available core
+    int cpu_chunk_size; // Number of individuals a CPU thread takes (or steals) at a time in the CPU backend
+    bool cpu_simd_batch; // If true, the CPU backend evaluates each chunk with rk4SimpleBatch() (RK_BATCH_LANES individuals in lockstep) instead of one at a time
+    double thrust_table_tol; // If above 0, the CPU backend interpolates each individual's thrust angles and coast value from a thrustTable accurate to this value instead of evaluating the Fourier series
+    int fitness_cache_size; // Number of evaluated genomes kept by the FitnessCache (rounded up to a power of two) so repeated children are not integrated again, 0 turns the cache off
+    double fitness_cache_tol; // If above 0, genomes are rounded to this relative precision before being looked up, so near duplicates share one evaluation, 0 only matches exact repeats
+    int screen_max_numsteps; // If above 0, new individuals are first integrated with at most this many steps (FitnessScreen) and only those that could be survivors are integrated again with the full settings, 0 integrates all of them with the full settings
+    double screen_tol; // rk_tol of the coarse pass when screen_max_numsteps is set, 0 uses rk_tol
+    double screen_margin; // Factor on the largest coarse error measured on the last refined individuals, coarse results within twice that of the survivor boundaries are integrated again
+    int prune_checkpoints; // If above 0, each trajectory is checked this many (evenly spaced) times while it is integrated and stopped if no thrusting could make it beat the last generation's survivors, 0 integrates every trajectory to the end
+    double prune_margin; // Factor on the survivor cutoffs for pruning (posDiff cutoff times this, velDiff cutoff over this), above 1 prunes less and allows for the bounds being estimates
+    bool kepler_coast; // If true, coast arcs (thrust off or fuel used up) are jumped over with keplerPropagate() instead of being integrated step by step
+    int step_control; // How the runge kutta step size is chosen, SCALE_STEP (each step rescales the next, none are rejected) or PI_STEP (steps over rk_tol are retried, PI control, steps end where the thrust switches), set in the config as SCALE or PI
+    int rk_tableau; // Butcher tableau of the embedded runge kutta pair used to evaluate individuals, DP5_TABLEAU (Dormand-Prince 5(4)), VERNER65_TABLEAU (Verner 6(5)), or DOP853_TABLEAU (Dormand-Prince 8(5,3)), set in the config as DP5, VERNER65, or DOP853
+    bool canonical_units; // If true, individuals are integrated in canonical units (AU, canonicalTime, the sun's gravitational parameter is 1) instead of AU and seconds, converted at the start and end of each integration
+    bool carry_stage; // If true (the default), the last stage of each step is carried to the first of the next for the first same as last pairs (DP5, VERNER65) instead of being found again, false is only for timing the difference
+    int verify_count; // Number of the best individuals integrated again to verify_tol with parareal (pararealIntegrate()) at the end of a run, 0 turns verification off
+    double verify_tol; // rk_tol of the fine propagator (DOP853) that verifies the best individuals
+    int verify_numsteps; // Fewest steps the fine propagator takes over the trip when verifying, it takes no longer steps than tripTime/verify_numsteps
+    int parareal_slices; // Time slices the trip is split into for verification, each integrated by its own thread of cpuPool, 0 uses one per thread (PARAREAL_SERIAL_SLICES or fewer integrates the trip serially)
+    double parareal_coarse_tol; // rk_tol of the coarse propagator (DP5) that finds and corrects the start of each slice
+
     // Used in generating time range for Earth calculations (units in seconds), distance between explicit time intervals stored
     int timeRes;
+    int earth_mode; // How EarthInfo finds earth's conditions, TABLE_EARTH (integrated table), KEPLER_EARTH (closed form two body motion, no table), or EPHEMERIS_EARTH (earth_ephemeris file), set in the config as TABLE, KEPLER, or EPHEMERIS
+    std::string earth_ephemeris; // Chebyshev ephemeris file (see ephemeris.h, written by buildEphemeris.cu) read when earth_mode is EPHEMERIS
+    int earth_segments; // If above 1, EarthInfo's table is integrated as this many segments at the same time on CPU threads, from checkpoints found by a coarse first pass
+    std::string earth_cache; // Folder that EarthInfo tables are saved to and mapped from (see earthCache.h), NONE to calculate the table every run
 
     // Default constructor, sets the config file path to be "genetic.config" for geneticFileRead()
     cudaConstants();
@@ -101,6 +128,36 @@ struct cudaConstants {
     // Output: Properties explicitly set in the config file are set to values following equal sign, ignores comments or empty lines in files 
     // Notice: This does not verify much, if anything, about the config file!
     void FileRead(std::string fileName);
+
+    // rk_backend enumeration, used for readibility in place of the hard-coded number values
+    enum RK_BACKEND {
+        GPU_BACKEND = 0,
+        CPU_BACKEND = 1
+    };
+
+    // earth_mode enumeration
+    enum EARTH_MODE {
+        TABLE_EARTH = 0,
+        KEPLER_EARTH = 1,
+        EPHEMERIS_EARTH = 2
+    };
+
+    // step_control enumeration
+    enum STEP_CONTROL {
+        SCALE_STEP = 0,
+        PI_STEP = 1
+    };
+
+    // rk_tableau enumeration
+    enum RK_TABLEAU {
+        DP5_TABLEAU = 0,
+        VERNER65_TABLEAU = 1,
+        DOP853_TABLEAU = 2
+    };
+
+    private:
+        // Sets the properties older config files may not have to their defaults, called by both constructors before FileRead()
+        void setDefaults();
 };
 
 // Output function to stream, with some formatting to help be more legible on terminal
@@ -0,0 +1,169 @@
+#include <fstream> // for writing the cache file
+#include <cstdio>  // for std::rename and std::remove
+#include <random>  // for the temporary file name
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX // keeps windows.h from defining min and max macros
+#include <windows.h>
+#else
+#include <sys/mman.h> // for mmap
+#include <sys/stat.h> // for fstat
+#include <fcntl.h>    // for open
+#include <unistd.h>   // for close
+#endif
+
+// Adds the bytes of a value to an FNV-1a hash
+void fnv1aAdd(uint64_t & hash, const void * value, size_t size) {
+    const unsigned char *bytes = static_cast<const unsigned char*>(value);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL; // FNV 64 bit prime
+    }
+}
+
+uint64_t earthCacheKey(const cudaConstants* cConstants) {
+    uint64_t hash = 14695981039346656037ULL; // FNV 64 bit offset basis
+
+    uint32_t version = EARTH_CACHE_VERSION;
+    fnv1aAdd(hash, &version, sizeof(version));
+
+    fnv1aAdd(hash, &cConstants->r_fin_earth, sizeof(double));
+    fnv1aAdd(hash, &cConstants->theta_fin_earth, sizeof(double));
+    fnv1aAdd(hash, &cConstants->z_fin_earth, sizeof(double));
+    fnv1aAdd(hash, &cConstants->vr_fin_earth, sizeof(double));
+    fnv1aAdd(hash, &cConstants->vtheta_fin_earth, sizeof(double));
+    fnv1aAdd(hash, &cConstants->vz_fin_earth, sizeof(double));
+    fnv1aAdd(hash, &cConstants->triptime_min, sizeof(double));
+    fnv1aAdd(hash, &cConstants->triptime_max, sizeof(double));
+    fnv1aAdd(hash, &cConstants->timeRes, sizeof(int));
+    fnv1aAdd(hash, &cConstants->rk_tol, sizeof(double));
+    fnv1aAdd(hash, &cConstants->min_numsteps, sizeof(int));
+    fnv1aAdd(hash, &cConstants->max_numsteps, sizeof(int));
+    fnv1aAdd(hash, &cConstants->doublePrecThresh, sizeof(double));
+    fnv1aAdd(hash, &cConstants->earth_segments, sizeof(int));
+
+    return hash;
+}
+
+std::string earthCacheFile(const cudaConstants* cConstants) {
+    char keyText[17];
+    snprintf(keyText, sizeof(keyText), "%016llx", static_cast<unsigned long long>(earthCacheKey(cConstants)));
+    return cConstants->earth_cache + "earthCache-" + keyText + ".bin";
+}
+
+bool writeEarthCache(const std::string & fileName, const earthCacheHeader & header, const double * data) {
+    // Unique temporary name so runs writing the same table at the same time do not mix their files
+    std::random_device rd;
+    std::string tempName = fileName + ".tmp" + std::to_string(rd());
+
+    std::ofstream file(tempName, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(data), 6*header.tolData*sizeof(double));
+    file.close();
+    if (!file) {
+        std::remove(tempName.c_str());
+        return false;
+    }
+
+    if (std::rename(tempName.c_str(), fileName.c_str()) != 0) {
+        // On Windows rename fails if the file exists, which means another run already wrote this table
+        std::remove(tempName.c_str());
+        std::ifstream existing(fileName, std::ios::binary);
+        return static_cast<bool>(existing);
+    }
+    return true;
+}
+
+MappedFile::MappedFile() {
+    address = nullptr;
+    length = 0;
+#ifdef _WIN32
+    fileHandle = INVALID_HANDLE_VALUE;
+    mappingHandle = nullptr;
+#endif
+}
+
+bool MappedFile::open(const std::string & fileName) {
+    close();
+#ifdef _WIN32
+    fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return false;
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr) {
+        close();
+        return false;
+    }
+    address = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (address == nullptr) {
+        close();
+        return false;
+    }
+#else
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    length = static_cast<size_t>(fileInfo.st_size);
+
+    void *mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping stays valid after the file is closed
+    if (mapping == MAP_FAILED) {
+        length = 0;
+        return false;
+    }
+    address = mapping;
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (address != nullptr) {
+        UnmapViewOfFile(address);
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+    }
+    fileHandle = INVALID_HANDLE_VALUE;
+    mappingHandle = nullptr;
+#else
+    if (address != nullptr) {
+        munmap(address, length);
+    }
+#endif
+    address = nullptr;
+    length = 0;
+}
+
+const void * MappedFile::data() {
+    return address;
+}
+
+size_t MappedFile::size() {
+    return length;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
@@ -0,0 +1,69 @@
+#ifndef EARTHCACHE_H
+#define EARTHCACHE_H
+
+#include <string>  // for file names
+#include <cstdint> // for uint64_t
+
+// Version of the cache file layout, older files are rebuilt if this changes
+#define EARTH_CACHE_VERSION 2
+
+// Start of an EarthInfo cache file, followed by the 6*tolData doubles of EarthInfo's earthData (r, theta, z, vr, vtheta, vz arrays in order)
+// Kept at 64 bytes so the data after it stays aligned when the file is mapped
+struct earthCacheHeader {
+    char magic[8];      // "EARTHTBL"
+    uint32_t version;   // EARTH_CACHE_VERSION
+    uint32_t valueSize; // sizeof(double), files from machines with a different double are not used
+    uint64_t key;       // earthCacheKey() of the config the table was built with
+    int64_t tolData;    // number of data points
+    double startTime;   // triptime_min (s)
+    double endTime;     // triptime_max (s)
+    double timeRes;     // resolution of the data points (s)
+    double unused;      // padding to 64 bytes
+};
+
+// Hash (64 bit FNV-1a) of every config value that changes the contents of the EarthInfo table
+//     r/theta/z/vr/vtheta/vz_fin_earth, triptime_min, triptime_max, timeRes, rk_tol
+//     and also min_numsteps, max_numsteps, doublePrecThresh, and earth_segments as they change the integration's steps
+// Input: cConstants - the config the table is for
+// Output: key identifying the table, used in the cache file's name and checked against its header
+uint64_t earthCacheKey(const cudaConstants* cConstants);
+
+// Name of the cache file for a config, earth_cache (the folder) followed by earthCache-[key in hex].bin
+std::string earthCacheFile(const cudaConstants* cConstants);
+
+// Writes a cache file, first to a temporary file that is then renamed so other runs never map a partly written file
+// Input: fileName - from earthCacheFile()
+//        header - filled in header for the data
+//        data - 6*header.tolData doubles to store
+// Output: returns true if the file was written (or another process finished writing the same file first)
+bool writeEarthCache(const std::string & fileName, const earthCacheHeader & header, const double * data);
+
+// Read-only memory mapping of a whole file, uses mmap on POSIX systems and CreateFileMapping on Windows
+class MappedFile {
+    private:
+        void *address; // start of the mapping, nullptr if nothing is mapped
+        size_t length; // size of the file in bytes
+#ifdef _WIN32
+        void *fileHandle;    // HANDLE from CreateFile
+        void *mappingHandle; // HANDLE from CreateFileMapping
+#endif
+
+    public:
+        MappedFile();
+
+        // Maps fileName, returns false if it could not be opened or mapped (such as it not existing yet)
+        bool open(const std::string & fileName);
+
+        // Unmaps the file, if one is mapped
+        void close();
+
+        // Start and size of the mapped file
+        const void * data();
+        size_t size();
+
+        // Unmaps the file
+        ~MappedFile();
+};
+
+#include "earthCache.cpp"
+#endif
@@ -1,87 +1,305 @@
 #include <iostream>  // cout
 #include <iomanip> // setprecision(int)  
+#include <cstring> // memcpy and memcmp for the cache file header
 
 // Constructor used to initialize the earth calculation data
-// Input: cConstants - Used to access impact date element data and the time range needed to be calculated (triptime max and min), passed into earthInitial_incremental()
+// Input: cConstants - Used to access impact date element data and the time range needed to be calculated (triptime max and min), passed into sweep()
 EarthInfo::EarthInfo(const cudaConstants* cConstants) {
     // Setting up initial information
     startTime = cConstants->triptime_min; // Starting time (s), chronologically this is closest to impact time (0 would be exactly impact date)
     endTime = cConstants->triptime_max;   // Ending time (s), chronologically this is earliest time away from impact date
     timeRes = cConstants->timeRes;        // Time resolution for storing data points (s)
-    tolData = ((endTime-startTime)/timeRes) + 1; // Total Number of Data points in earthCon based on duration in seconds divided by resolution, plus one for the last 'section'
+    tolData = ((endTime-startTime)/timeRes) + 1; // Total Number of Data points based on duration in seconds divided by resolution, plus one for the last 'section', the length of each element array
 
-    // Alocate memory for earthCon, one entry for every data point
-    earthCon = new elements<double> [tolData];
+    earthData = nullptr;
+    seamPosError = 0;
+    seamVelError = 0;
 
-    // Assigning the position of the earth at impact to variable earth. Passed into earthInitial_incremental and rk4Reverse.
+    mode = cConstants->earth_mode;
+    if (mode == cudaConstants::KEPLER_EARTH) {
+        elements<double> impact = elements<double>(cConstants->r_fin_earth, cConstants->theta_fin_earth, cConstants->z_fin_earth, cConstants->vr_fin_earth, cConstants->vtheta_fin_earth, cConstants->vz_fin_earth);
+        impactState = cylindricalToCartesian(impact);
+        impactTheta = impact.theta;
+
+        // Mean motion from the semi-major axis, sqrt(mu/a^3)
+        double mu = constG * massSun;
+        double alpha = 2/sqrt(impact.r*impact.r + impact.z*impact.z) - (impact.vr*impact.vr + impact.vtheta*impact.vtheta + impact.vz*impact.vz)/mu;
+        meanMotion = sqrt(mu*alpha*alpha*alpha);
+        if (impact.vtheta < 0) {
+            meanMotion = -meanMotion;
+        }
+        r = theta = z = vr = vtheta = vz = nullptr;
+
+        std::cout << "Earth positions found from its two body orbit (earth_mode=KEPLER), no table calculated\n\n";
+        return;
+    }
+
+    if (mode == cudaConstants::EPHEMERIS_EARTH) {
+        elements<double> impact = elements<double>(cConstants->r_fin_earth, cConstants->theta_fin_earth, cConstants->z_fin_earth, cConstants->vr_fin_earth, cConstants->vtheta_fin_earth, cConstants->vz_fin_earth);
+        if (ephemeris.open(cConstants->earth_ephemeris) && ephemeris.covers(impact, startTime, endTime)) {
+            r = theta = z = vr = vtheta = vz = nullptr;
+            std::cout << "Earth positions read from the ephemeris file " << cConstants->earth_ephemeris << "\n\n";
+            return;
+        }
+        // Use the table instead, the file is missing, not an ephemeris file, or is for a different impact or time range
+        std::cout << "Ephemeris file " << cConstants->earth_ephemeris << " is missing or does not cover the Earth's impact conditions and trip time range, using the table instead\n";
+        ephemeris.close();
+        mode = cudaConstants::TABLE_EARTH;
+    }
+
+    // Use the table saved by an earlier run (or another process) with the same config if there is one
+    std::string cacheName;
+    if (cConstants->earth_cache != "NONE") {
+        cacheName = earthCacheFile(cConstants);
+        if (loadCache(cacheName, earthCacheKey(cConstants))) {
+            std::cout << "Earth positions for the trip time range loaded from " << cacheName << "\n\n";
+            return;
+        }
+    }
+
+    // Alocate memory for the earth data, one block holding each element's array of tolData values
+    earthData = new double [6*tolData];
+    setArrays(earthData);
+
+    // Assigning the position of the earth at impact to variable earth, the start of the reverse integration
     elements<double> earth = elements<double>(cConstants->r_fin_earth, cConstants->theta_fin_earth, cConstants->z_fin_earth, cConstants->vr_fin_earth, cConstants->vtheta_fin_earth, cConstants->vz_fin_earth);
 
-    // Get the initial position and velocity of the earth from startTime away from impact date.
-    earth = earthInitial_incremental(0, startTime, earth, cConstants);
+    // Each segment needs at least one data point of its own
+    int segmentCount = cConstants->earth_segments;
+    if (segmentCount > tolData - 1) {
+        segmentCount = tolData - 1;
+    }
+
+    if (segmentCount > 1) {
+        std::cout << "Calculating earth positions for the trip time range in " << segmentCount << " segments" << std::endl;
+        sweepSegments(earth, segmentCount, cConstants);
+        std::cout << "Largest error at the segment boundaries: " << seamPosError << " AU, " << seamVelError << " AU/s\n\n";
+    }
+    else {
+        // Shows progress of earth position calculations before the optimization in cuda can occur.
+        std::cout << "Calculating earth positions for the trip time range" << std::endl;
+        std::cout << "          10 20 30 40 50 60 70 80 90 100" << std::endl;
+        std::cout << "progress:[";
+
+        // One continuous integration from impact back to the last data point, starting at the smallest allowed step
+        sweep(earth, 0, endTime / cConstants->max_numsteps, 0, tolData-1, cConstants, true);
+
+        // Closing progress bar and adding a couple of empty line spaces
+        std::cout << "]\n\n";
+    }
+
+    // Save the table for later runs with the same config
+    if (cConstants->earth_cache != "NONE") {
+        earthCacheHeader header = {};
+        memcpy(header.magic, "EARTHTBL", 8);
+        header.version = EARTH_CACHE_VERSION;
+        header.valueSize = sizeof(double);
+        header.key = earthCacheKey(cConstants);
+        header.tolData = tolData;
+        header.startTime = startTime;
+        header.endTime = endTime;
+        header.timeRes = timeRes;
+
+        if (!writeEarthCache(cacheName, header, earthData)) {
+            std::cout << "Could not write the earth cache file " << cacheName << ", it will be calculated again next run\n\n";
+        }
+    }
+}
 
-    // Setting the first element of earthCon to be equal to the earth conditions at startTime away from impact
-    earthCon[0] = earth;
+// Integrates earth backwards in one continuous sweep, writing each data point from the dense output of the step that passes it
+double EarthInfo::sweep(elements<double> & y, double curTime, double stepSize, const int & firstIndex, const int & lastIndex, const cudaConstants* cConstants, const bool & showProgress) {
+    // Step size limits over the whole time range, as rk4Reverse() uses over its range
+    double maxStep = endTime / cConstants->min_numsteps;
+    double minStep = endTime / cConstants->max_numsteps;
+    double lastTime = calc_time(lastIndex);
 
-    // Shows progress of earth position calculations before the optimization in cuda can occur.
-    std::cout << "Calculating earth positions for the trip time range" << std::endl;
-    std::cout << "          10 20 30 40 50 60 70 80 90 100" << std::endl;
-    std::cout << "progress:[";
+    elements<double> start; // earth at the start of the current step
+    elements<double> error; // error estimate of the current step from rkCalcEarth
+    elements<double> stages[7]; // k values of the current step, for dense output
+    stageCache<double> cache;   // carries k7 of each step to k1 of the next
 
-    // Iterate backwards until total number of data points acquired
-    for (int i = 1; i < tolData; i++) { 
-        // Calculates earth's condition at each point (time) from the previously calculated point.
-        earthCon[i] = earthInitial_incremental(calc_time(i)-timeRes, calc_time(i), earth, cConstants); // Obtaining conditions of the earth
+    int index = firstIndex; // next data point to be written
 
-        // Filling progress bar, 30 value derived from the fact that there is 30 character spaces to fill in progress bar
-        if ((i % (tolData/30)) == 0) {
-            std::cout << ">";
+    while (index <= lastIndex) {
+        // Don't step past the last data point
+        if (curTime + stepSize > lastTime) {
+            stepSize = lastTime - curTime;
         }
 
-        // Sets earth equal to the conditions calculated for a given time to be used as reference point in next usage of earthInitial_incremental
-        earth = earthCon[i];
+        start = y;
+        rkCalcEarth(curTime, endTime, stepSize, y, error, stages, &cache);
+        double stepEnd = curTime + stepSize;
+
+        // Write every data point the step passed, using the step's value for one at its very end
+        while (index <= lastIndex && calc_time(index) <= stepEnd) {
+            if (calc_time(index) == stepEnd) {
+                setCondition(index, y);
+            }
+            else {
+                setCondition(index, rkDenseOutput(start, stages, (calc_time(index) - curTime) / stepSize));
+            }
+
+            // Filling progress bar, 30 value derived from the fact that there is 30 character spaces to fill in progress bar
+            // (tolData can be under 30 when timeRes is large)
+            if (showProgress && index > 0 && (tolData < 30 || (index % (tolData/30)) == 0)) {
+                std::cout << ">";
+            }
+            index++;
+        }
+        curTime = stepEnd;
+
+        // Alter the step size for the next step, the step size carries over from one data point to the next
+        stepSize *= calc_scalingFactor(y-error, error, cConstants->rk_tol, cConstants->doublePrecThresh);
+        if (stepSize > maxStep) {
+            stepSize = maxStep;
+        }
+        else if (stepSize < minStep) {
+            stepSize = minStep;
+        }
+    }
+    return stepSize;
+}
+
+// Integrates earth backwards to exactly targetTime in fixed steps, used for the coarse pass of sweepSegments()
+void EarthInfo::advance(elements<double> & y, double & curTime, const double & targetTime, const cudaConstants* cConstants) {
+    double stepSize = endTime / cConstants->min_numsteps;
+    elements<double> error; // unused, the steps are not adapted
+    stageCache<double> cache; // carries k7 of each step to k1 of the next
+
+    while (curTime < targetTime) {
+        // Don't step past targetTime
+        if (curTime + stepSize > targetTime) {
+            stepSize = targetTime - curTime;
+        }
+        rkCalcEarth<double>(curTime, endTime, stepSize, y, error, nullptr, &cache);
+        curTime += stepSize;
+    }
+    // Land exactly on targetTime so the segment starts from its data point's time
+    curTime = targetTime;
+}
+
+// Fills the table in segments on CPU threads, from checkpoints found by a coarse pass
+void EarthInfo::sweepSegments(const elements<double> & impact, const int & segmentCount, const cudaConstants* cConstants) {
+    earthSegment *segments = new earthSegment[segmentCount];
+
+    // Split the data points evenly, segment s writes the data points after its start up to and including the next segment's start
+    for (int s = 0; s < segmentCount; s++) {
+        int startIndex = static_cast<int>((static_cast<long long>(s) * (tolData-1)) / segmentCount);
+        segments[s].firstIndex = (s == 0) ? 0 : startIndex + 1;
+        segments[s].lastIndex = static_cast<int>((static_cast<long long>(s+1) * (tolData-1)) / segmentCount);
+        segments[s].startTime = (s == 0) ? 0 : calc_time(startIndex);
+    }
+
+    // Coarse pass, one integration from impact stopping at each segment's start time
+    elements<double> y = impact;
+    double curTime = 0;
+    for (int s = 0; s < segmentCount; s++) {
+        advance(y, curTime, segments[s].startTime, cConstants);
+        segments[s].start = y;
+    }
+
+    // Fill the segments at the same time, using the CPU backend's threads if there are any
+    segmentJob job = {this, segments, segmentCount, cConstants};
+    if (cpuPool != nullptr) {
+        cpuPool->run(segmentWorker, &job);
+    }
+    else {
+        ThreadPool segmentPool(segmentCount < static_cast<int>(std::thread::hardware_concurrency()) ? segmentCount : 0);
+        segmentPool.run(segmentWorker, &job);
+    }
+
+    // Continuity at the seams, the last value written by each segment against the checkpoint the next one started from
+    for (int s = 1; s < segmentCount; s++) {
+        elements<double> seam = getStored(segments[s].firstIndex - 1) - segments[s].start;
+        double posError = sqrt(seam.r*seam.r + segments[s].start.r*segments[s].start.r*seam.theta*seam.theta + seam.z*seam.z);
+        double velError = sqrt(seam.vr*seam.vr + seam.vtheta*seam.vtheta + seam.vz*seam.vz);
+        if (posError > seamPosError) {
+            seamPosError = posError;
+        }
+        if (velError > seamVelError) {
+            seamVelError = velError;
+        }
+    }
+
+    delete [] segments;
+}
+
+void EarthInfo::segmentWorker(int threadId, int numThreads, void* context) {
+    segmentJob *job = static_cast<segmentJob*>(context);
+
+    for (int s = threadId; s < job->count; s += numThreads) {
+        earthSegment & segment = job->segments[s];
+        elements<double> y = segment.start;
+        job->earth->sweep(y, segment.startTime, job->earth->endTime / job->cConstants->max_numsteps, segment.firstIndex, segment.lastIndex, job->cConstants, false);
     }
-    // Closing progress bar and adding a couple of empty line spaces
-    std::cout << "]\n\n";
 }
 
 // Returns conditions of earth for a given time input
 // Input: currentTime - time offset from impact backwards in time (larger value refers further back) in units of seconds
-// Output: Returns an element that is to earth's position/velocity at currentTime away from impact using interpolate
-//         as currentTime very likely does not directly corelate to an explicit derived element in earthCon
-elements<double> EarthInfo::getCondition(const double & currentTime) {
-    // Defining variables to use
-    elements<double> lower;
-    elements<double> upper;
-    elements<double> result;
-    
-    int index;
-    // Setting index equal to the nearest index of data based on time
-    index = calcIndex(currentTime); 
-    
-    if (index < calcIndex(startTime)) {
-        std::cout << "Earth condition index being accessed is less than startTime! Returning nearest index\n";
-        index = calcIndex(startTime);
+// Output: result is set to earth's position/velocity at currentTime away from impact using interpolate
+//         as currentTime very likely does not directly corelate to an explicit derived element in the table
+//         Returns EARTH_OK, or EARTH_BEFORE_START/EARTH_AFTER_END if currentTime had to be clamped to the table
+int EarthInfo::getCondition(const double & currentTime, elements<double> & result) {
+    int status = EARTH_OK;
+    double time = currentTime;
+
+    if (time < startTime) {
+        status = EARTH_BEFORE_START;
+        time = startTime;
+    }
+    else if (time > endTime) {
+        status = EARTH_AFTER_END;
+        time = endTime;
     }
-    else if (index > calcIndex(endTime) - 1) {
-        std::cout << "Earth condition index being accessed is greater than to endTime-1! Returning nearest valid index\n";
-        index = calcIndex(endTime) - 1; // is (index-1) because the index variable is the lower of two, the keeps from going out of bounds with the upper index value 
+
+    if (mode == cudaConstants::KEPLER_EARTH) {
+        result = keplerCondition(time);
+        return status;
+    }
+    else if (mode == cudaConstants::EPHEMERIS_EARTH) {
+        result = ephemeris.getCondition(time);
+        return status;
     }
 
-    // The lower index weight is equal to the index
-    lower = earthCon[index];
-    // The upper index weight is equal to the index plus 1
-    upper = earthCon[index + 1];
+    // Setting index equal to the nearest index of data below time
+    int index = calcIndex(time);
+    if (index > tolData - 2) {
+        index = tolData - 2; // index is the lower of two, this keeps from going out of bounds with the upper index value
+    }
 
-    // Weights are used for interpolation
-    double lowerWeight = 1 - ((currentTime-calc_time(index)) / timeRes);
-    double upperWeight = 1 - ((calc_time(index+1)-currentTime) / timeRes);
+    result = interpolate(index, time);
 
-    // Derive the element of Earth at this time using interpolate
-    result = interpolate(lower,upper,lowerWeight,upperWeight);
+    return status;
+}
 
+elements<double> EarthInfo::getCondition(const double & currentTime) {
+    elements<double> result;
+    getCondition(currentTime, result);
     return result;
 }
 
+int EarthInfo::getConditions(const double times[], elements<double> results[], const int & count, int status[]) {
+    int outOfRange = 0;
+    int curStatus;
+    for (int i = 0; i < count; i++) {
+        curStatus = getCondition(times[i], results[i]);
+        if (curStatus != EARTH_OK) {
+            outOfRange++;
+        }
+        if (status != nullptr) {
+            status[i] = curStatus;
+        }
+    }
+    return outOfRange;
+}
+
+// Propagates earth's impact conditions back by currentTime
+elements<double> EarthInfo::keplerCondition(const double & currentTime) {
+    cartesianState<double> state = keplerPropagate(impactState, -currentTime, static_cast<double>(constG * massSun));
+    // Earth is within a few hundredths of a radian of its average angle, so this gives the unwrapped theta the table would have
+    return cartesianToCylindrical(state, impactTheta - meanMotion*currentTime);
+}
+
 // Takes in a time and outputs a corresponding index (location of data).
 int EarthInfo::calcIndex(const double & currentTime) {
    return static_cast<int>((currentTime-startTime)/timeRes);
@@ -97,19 +315,89 @@ int EarthInfo::getTolData() {
     return tolData;
 }
 
-// Takes in the lower index, upper index, and their weights in order to calculate an approximate Earth element for a time between two index.
-// Input: lower & upper - elements that the interpolate is between of
-//        lowerWeight & upperWeight - weight values to adjust the interpolation in cases where the time is closer to one index than another (not midpoint)
-elements<double> EarthInfo::interpolate(const elements<double> & lower,const elements<double> & upper,const double & lowerWeight,const double & upperWeight) {
-    return (lower*lowerWeight)+(upper*upperWeight);
+double EarthInfo::getSeamPosError() {
+    return seamPosError;
+}
+
+double EarthInfo::getSeamVelError() {
+    return seamVelError;
+}
+
+// Points the element arrays into a block of 6*tolData doubles
+void EarthInfo::setArrays(const double * block) {
+    r = block;
+    theta = block + tolData;
+    z = block + 2*tolData;
+    vr = block + 3*tolData;
+    vtheta = block + 4*tolData;
+    vz = block + 5*tolData;
+}
+
+// Maps a cache file and uses it as the table if it matches
+bool EarthInfo::loadCache(const std::string & fileName, const uint64_t & key) {
+    if (!cache.open(fileName)) {
+        return false;
+    }
+
+    // Check the header and size before using the data
+    const earthCacheHeader *header = static_cast<const earthCacheHeader*>(cache.data());
+    if (cache.size() != sizeof(earthCacheHeader) + 6*tolData*sizeof(double) || memcmp(header->magic, "EARTHTBL", 8) != 0 ||
+        header->version != EARTH_CACHE_VERSION || header->valueSize != sizeof(double) || header->key != key ||
+        header->tolData != tolData || header->startTime != startTime || header->endTime != endTime || header->timeRes != timeRes) {
+        cache.close();
+        return false;
+    }
+
+    setArrays(reinterpret_cast<const double*>(header + 1));
+    return true;
+}
+
+// Stores earth's conditions at index, only used while calculating the table (into earthData)
+void EarthInfo::setCondition(const int & index, const elements<double> & earth) {
+    earthData[index] = earth.r;
+    earthData[tolData + index] = earth.theta;
+    earthData[2*tolData + index] = earth.z;
+    earthData[3*tolData + index] = earth.vr;
+    earthData[4*tolData + index] = earth.vtheta;
+    earthData[5*tolData + index] = earth.vz;
+}
+
+// Returns the stored earth conditions at index
+elements<double> EarthInfo::getStored(const int & index) {
+    return elements<double>(r[index], theta[index], z[index], vr[index], vtheta[index], vz[index]);
+}
+
+// Cubic Hermite interpolation of earth's conditions between index and index+1
+elements<double> EarthInfo::interpolate(const int & index, const double & currentTime) {
+    elements<double> lower = getStored(index);
+    elements<double> upper = getStored(index + 1);
+
+    // Derivatives with respect to currentTime, calc_kEarth() multiplies the rates by the step so a step of -1 gives the
+    // negated rates, as currentTime moves backwards in time
+    elements<double> lowerRate = calc_kEarth(static_cast<double>(-1), lower, currentTime, endTime);
+    elements<double> upperRate = calc_kEarth(static_cast<double>(-1), upper, currentTime, endTime);
+
+    // Position between the two data points, 0 at lower and 1 at upper
+    double u = (currentTime - calc_time(index)) / timeRes;
+    double u2 = u*u;
+    double u3 = u2*u;
+
+    // Hermite basis functions
+    double h00 = 2*u3 - 3*u2 + 1;
+    double h10 = u3 - 2*u2 + u;
+    double h01 = -2*u3 + 3*u2;
+    double h11 = u3 - u2;
+
+    return lower*h00 + lowerRate*(h10*timeRes) + upper*h01 + upperRate*(h11*timeRes);
 }
 
-// Destructor, deallocates earthCon data
+// Destructor, deallocates earthData
 EarthInfo::~EarthInfo() {
-    delete [] earthCon;
+    delete [] earthData;
 }
 
-// Determines the next step back from a given element using rk4Reverse, used in the constructor of EarthInfo
+// Determines the next step back from a given element using its own rk4Reverse
+// No longer used to fill EarthInfo's table (see sweep()), useful as an independent check of its values
 // Input for earthInitial_incremental:
 //      timeInitial: time (in seconds) of the impact date
 //      tripTime: optimized time period of the overall trip
@@ -4,48 +4,163 @@
 #include "../Motion_Eqns/elements.h"
 #include "../Config_Constants/config.h"
 #include "../Runge_Kutta/runge_kutta.h"
+#include "../Motion_Eqns/kepler.h" // for earth_mode=KEPLER
+#include "ephemeris.h" // for earth_mode=EPHEMERIS
+#include "earthCache.h" // for saving and mapping the table
+#include "../Host_Threads/threadPool.h" // for cpuPool, used to integrate the table's segments at the same time
 
 class EarthInfo {
     private:
-        // Elements pointer array that holds all of the earth conditions for a given time range
-        elements<double> *earthCon;
+        // Earth conditions for the time range in structure-of-arrays form, one block of 6*tolData doubles
+        // Allocated when the table is calculated, nullptr when the table is mapped from a cache file
+        double *earthData;
+        // Cache file holding the table when it was found from an earlier run (see earthCache.h)
+        MappedFile cache;
+        // r, theta, z, vr, vtheta, and vz each point to tolData consecutive values in earthData or the mapped cache file
+        const double *r, *theta, *z, *vr, *vtheta, *vz;
         // First time point for a given time span offseted from impact date, units of seconds
         double startTime;
         // Last time point for a given time span offseted from impact date, units of seconds
         double endTime;
         // The resolution of data points (ex: 3600 = hours, 60 = minutes, 1 = seconds)
         double timeRes;
-        // The total amount of data points for a run. Calculated by time span divided by timeRes. Is the length of earthCon
+        // The total amount of data points for a run. Calculated by time span divided by timeRes. Is the length of each array in earthData
         int tolData;
 
+        // earth_mode from the config, TABLE_EARTH, KEPLER_EARTH, or EPHEMERIS_EARTH
+        int mode;
+        // Used when mode is KEPLER_EARTH, earth's conditions at impact in cartesian coordinates and cylindrical theta
+        cartesianState<double> impactState;
+        double impactTheta;
+        // Average angular rate of earth's orbit (rad/s), signed by its direction, to estimate theta for unwrapping
+        double meanMotion;
+
+        // Used when mode is EPHEMERIS_EARTH, the mapped earth_ephemeris file
+        ChebyshevEphemeris ephemeris;
+
+        // Closed form earth conditions with keplerPropagate(), used when mode is KEPLER_EARTH
+        // Input: currentTime - time offset from impact backwards in time (s)
+        elements<double> keplerCondition(const double & currentTime);
+
         // Takes in a time and outputs a corresponding index (location of data).
         int calcIndex(const double & currentTime);
         // Takes in an index and outputs the time corresponded to that index.
         double calc_time(const int & currentIndex);
 
-        // Takes in the lower index, upper index, and their weights in order to calculate an approximate Earth element for a time between two index.
-        // Input: lower & upper - elements that the interpolate is between of
-        //        lowerWeight & upperWeight - weight values to adjust the interpolation in cases where the time is closer to one index than another (not midpoint)
-        elements<double> interpolate(const elements<double> & lower, const elements<double> & upper, const double & lowerWeight, const double & upperWeight);
+        // Points r, theta, z, vr, vtheta, and vz at the six arrays of a block of 6*tolData doubles
+        void setArrays(const double * block);
+
+        // Maps the cache file fileName and uses it as the table if its header matches key and this table's time range
+        // Output: returns false (leaving nothing mapped) if the file does not exist or does not match
+        bool loadCache(const std::string & fileName, const uint64_t & key);
+
+        // Integrates earth backwards from curTime in one continuous sweep (adaptive Dormand-Prince, step size carried from step to step),
+        // writing data points firstIndex to lastIndex from the dense output of the step that passes each of them
+        // Input: y - earth's conditions at curTime (time offset from impact, s), curTime must not be after calc_time(firstIndex)
+        //        stepSize - first step size (s), steps are kept between endTime/max_numsteps and endTime/min_numsteps
+        //        cConstants - rk_tol, doublePrecThresh, and the step limits
+        //        showProgress - if true, fills in the progress bar as data points are written
+        // Output: data points firstIndex to lastIndex are set, y is left as earth's conditions at calc_time(lastIndex)
+        //         returns the step size reached
+        double sweep(elements<double> & y, double curTime, double stepSize, const int & firstIndex, const int & lastIndex, const cudaConstants* cConstants, const bool & showProgress);
+
+        // Piece of the table integrated by its own thread when earth_segments is above 1
+        struct earthSegment {
+            elements<double> start; // earth's conditions at startTime, from the coarse pass (impact for the first segment)
+            double startTime;       // time offset from impact the segment's integration starts at (s)
+            int firstIndex;         // first data point the segment writes
+            int lastIndex;          // last data point the segment writes, the next segment starts at its time
+        };
+
+        // Context for segmentWorker()
+        struct segmentJob {
+            EarthInfo *earth;
+            earthSegment *segments;
+            int count;
+            const cudaConstants *cConstants;
+        };
+
+        // Largest difference at a segment boundary between the value written by the segment ending there and
+        // the coarse pass checkpoint the next segment started from, 0 if the table was not built in segments
+        double seamPosError; // position difference (AU)
+        double seamVelError; // velocity difference (AU/s)
+
+        // Integrates earth backwards from curTime to exactly targetTime without writing data points, in fixed steps of
+        // endTime/min_numsteps (the largest step sweep() takes) with no step size control, so it is far cheaper than sweep()
+        // over the same time but only as accurate as those steps allow
+        // Input: y - earth's conditions at curTime, cConstants - min_numsteps
+        // Output: y and curTime are set to earth's conditions at targetTime and targetTime
+        void advance(elements<double> & y, double & curTime, const double & targetTime, const cudaConstants* cConstants);
+
+        // Fills the table as segmentCount segments integrated at the same time on cpuPool (or a pool made for it)
+        // A coarse pass with advance() finds earth's conditions at each segment's start, then each segment is filled by sweep()
+        // Every segment after the first inherits the coarse pass's error at its start, which the seam errors measure
+        // Input: impact - earth's conditions at impact, segmentCount - number of segments (2 to tolData-1)
+        // Output: the table is filled, seamPosError and seamVelError are set
+        void sweepSegments(const elements<double> & impact, const int & segmentCount, const cudaConstants* cConstants);
+
+        // ThreadPool task for sweepSegments(), each thread fills every numThreads'th segment starting at threadId
+        static void segmentWorker(int threadId, int numThreads, void* context);
+
+        // Stores earth's conditions at index
+        void setCondition(const int & index, const elements<double> & earth);
+        // Returns the stored earth conditions at index
+        elements<double> getStored(const int & index);
+
+        // Cubic Hermite interpolation of earth's conditions between index and index+1
+        // The derivatives at the two data points are earth's velocity and two body acceleration (calc_kEarth()),
+        // negated as currentTime counts backwards from impact
+        // Input: index - lower of the two data points, currentTime - time between them
+        elements<double> interpolate(const int & index, const double & currentTime);
+
+        public:
+        // Status codes returned by getCondition() and getConditions()
+        enum EARTH_STATUS {
+            EARTH_OK = 0,           // currentTime is within startTime to endTime
+            EARTH_BEFORE_START = 1, // currentTime is before startTime, the result is for startTime
+            EARTH_AFTER_END = 2     // currentTime is after endTime, the result is for endTime
+        };
 
-    public:
         // Constructor used to initialize the earth calculation data
-        // Input: cConstants - Used to access impact date element data and the time range needed to be calculated (triptime max and min), passed into earthInitial_incremental()
+        // The table is filled by one reverse integration from impact with sweep(), or if earth_segments is above 1
+        // by that many segments integrated on separate threads (sweepSegments())
+        // If earth_mode is KEPLER, no table is made and getCondition() propagates earth's impact conditions instead
+        // If earth_mode is EPHEMERIS, no table is made and getCondition() evaluates the earth_ephemeris file instead (if it
+        // matches the impact conditions and covers the trip time range, otherwise the table is used)
+        // If earth_cache is not NONE, the table is mapped from the cache file for this config when one exists, otherwise it is calculated and saved there
+        // Input: cConstants - Used to access impact date element data and the time range needed to be calculated (triptime max and min), passed into sweep()
         EarthInfo(const cudaConstants* cConstants);
         
-        // Returns the interpolated conditions of earth for a given time input, using interpolate if currentTime does not directly corelate to an explicit derived element in earthCon
-        // Output: Returns an element that is to earth's position/velocity at currentTime away from impact (backwards)
+        // Returns the interpolated conditions of earth for a given time input
+        // Input: currentTime - time offset from impact backwards in time (s)
+        // Output: result is set to earth's position/velocity at currentTime away from impact (backwards),
+        //         returns an EARTH_STATUS, times outside of the table are clamped to its nearest end
+        int getCondition(const double & currentTime, elements<double> & result);
+
+        // Same as above but returns the conditions, out of range times are clamped without reporting it
         elements<double> getCondition(const double & currentTime);
 
+        // Batched getCondition() for a whole set of times, such as the trip times of a generation
+        // Input: times - count times to get conditions for (s)
+        //        status - optional, if not nullptr is filled with the EARTH_STATUS of each time
+        // Output: results[i] is set to earth's conditions at times[i], returns how many times were out of range
+        int getConditions(const double times[], elements<double> results[], const int & count, int status[] = nullptr);
+
         // Returns the total amount of data for a run with a given time span and resolution.
         int getTolData();
 
+        // Returns the largest position (AU) and velocity (AU/s) mismatch at the segment boundaries when the table was
+        // calculated in segments, both 0 if it was calculated in one sweep or loaded from the cache
+        double getSeamPosError();
+        double getSeamVelError();
+
         // Clears dynamic memory, used at end of program when optimize run is completed
-        // Deallocates earthCon data
+        // Deallocates earthData (the cache file, if used, is unmapped by its destructor)
         ~EarthInfo();
 };
 
-// Determines the next step back from a given element using rk4Reverse, used in the constructor of EarthInfo
+// Determines the next step back from a given element using its own rk4Reverse
+// No longer used to fill EarthInfo's table (see sweep()), useful as an independent check of its values
 // Input for earthInitial_incremental:
 //      timeInitial: time (in seconds) of the impact date
 //      tripTime: optimized time period of the overall trip
@@ -0,0 +1,166 @@
+#include <fstream> // for writing the ephemeris file
+#include <cstring> // memcpy and memcmp for the header
+#include <math.h>  // cos, ceil
+
+double chebyshevNode(const int & j, const int & degree) {
+    return cos(M_PI*(j + 0.5)/(degree + 1));
+}
+
+void fitChebyshev(const elements<double> values[], const int & degree, double coeff[]) {
+    int n = degree + 1;
+    for (int k = 0; k < n; k++) {
+        elements<double> sum;
+        for (int j = 0; j < n; j++) {
+            sum = sum + values[j]*cos(M_PI*k*(j + 0.5)/n);
+        }
+        // The first coefficient has half the weight of the others
+        sum = sum*((k == 0 ? 1.0 : 2.0)/n);
+
+        coeff[6*k] = sum.r;
+        coeff[6*k + 1] = sum.theta;
+        coeff[6*k + 2] = sum.z;
+        coeff[6*k + 3] = sum.vr;
+        coeff[6*k + 4] = sum.vtheta;
+        coeff[6*k + 5] = sum.vz;
+    }
+}
+
+elements<double> clenshaw(const double coeff[], const int & degree, const double & x) {
+    double b1[6] = {0, 0, 0, 0, 0, 0};
+    double b2[6] = {0, 0, 0, 0, 0, 0};
+    double x2 = 2*x;
+
+    // b[k] = c[k] + 2x b[k+1] - b[k+2] from the highest order down to 1
+    for (int k = degree; k >= 1; k--) {
+        const double *c = coeff + 6*k;
+        for (int i = 0; i < 6; i++) {
+            double b0 = c[i] + x2*b1[i] - b2[i];
+            b2[i] = b1[i];
+            b1[i] = b0;
+        }
+    }
+
+    double result[6];
+    for (int i = 0; i < 6; i++) {
+        result[i] = coeff[i] + x*b1[i] - b2[i];
+    }
+    return elements<double>(result[0], result[1], result[2], result[3], result[4], result[5]);
+}
+
+double * buildEphemeris(const elements<double> & epoch, const double & startTime, const double & endTime, const double & segmentLength, const int & degree,
+                        const cudaConstants* cConstants, ephemerisHeader & header) {
+    int n = degree + 1;
+    int64_t segmentCount = static_cast<int64_t>(ceil((endTime - startTime)/segmentLength));
+    if (segmentCount < 1) {
+        segmentCount = 1;
+    }
+
+    header = {};
+    memcpy(header.magic, "CHEBEPHM", 8);
+    header.version = EPHEMERIS_VERSION;
+    header.degree = degree;
+    header.segmentCount = segmentCount;
+    header.startTime = startTime;
+    header.endTime = startTime + segmentCount*segmentLength;
+    header.segmentLength = segmentLength;
+    header.epoch[0] = epoch.r;
+    header.epoch[1] = epoch.theta;
+    header.epoch[2] = epoch.z;
+    header.epoch[3] = epoch.vr;
+    header.epoch[4] = epoch.vtheta;
+    header.epoch[5] = epoch.vz;
+
+    double *coeff = new double [segmentCount*n*6];
+    elements<double> *values = new elements<double> [n];
+
+    // Propagate from one node to the next in order of time, the nodes of a segment go from its start (x = -1, j = degree) to its end
+    elements<double> y = epoch;
+    double curTime = 0;
+    for (int64_t s = 0; s < segmentCount; s++) {
+        double segmentStart = startTime + s*segmentLength;
+        for (int j = degree; j >= 0; j--) {
+            double nodeTime = segmentStart + (chebyshevNode(j, degree) + 1)*segmentLength/2;
+            double duration = nodeTime - curTime;
+            rk4Reverse(static_cast<double>(0), duration, y, duration/cConstants->min_numsteps, values[j], cConstants->rk_tol, cConstants);
+            curTime = nodeTime;
+            y = values[j];
+        }
+        fitChebyshev(values, degree, coeff + s*n*6);
+    }
+
+    delete [] values;
+    return coeff;
+}
+
+bool writeEphemeris(const std::string & fileName, const ephemerisHeader & header, const double * coeff) {
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(ephemerisHeader));
+    file.write(reinterpret_cast<const char*>(coeff), header.segmentCount*(header.degree + 1)*6*sizeof(double));
+    return static_cast<bool>(file);
+}
+
+ChebyshevEphemeris::ChebyshevEphemeris() {
+    header = nullptr;
+    coeff = nullptr;
+}
+
+bool ChebyshevEphemeris::open(const std::string & fileName) {
+    close();
+    if (!file.open(fileName)) {
+        return false;
+    }
+
+    // Check the header and size before using the coefficients
+    const ephemerisHeader *fileHeader = static_cast<const ephemerisHeader*>(file.data());
+    if (file.size() < sizeof(ephemerisHeader) || memcmp(fileHeader->magic, "CHEBEPHM", 8) != 0 || fileHeader->version != EPHEMERIS_VERSION ||
+        fileHeader->degree > EPHEMERIS_MAX_DEGREE || fileHeader->segmentCount < 1 ||
+        file.size() != sizeof(ephemerisHeader) + fileHeader->segmentCount*(fileHeader->degree + 1)*6*sizeof(double)) {
+        file.close();
+        return false;
+    }
+
+    header = fileHeader;
+    coeff = reinterpret_cast<const double*>(header + 1);
+    return true;
+}
+
+void ChebyshevEphemeris::close() {
+    file.close();
+    header = nullptr;
+    coeff = nullptr;
+}
+
+bool ChebyshevEphemeris::covers(const elements<double> & epoch, const double & startTime, const double & endTime) {
+    if (header == nullptr) {
+        return false;
+    }
+    return header->epoch[0] == epoch.r && header->epoch[1] == epoch.theta && header->epoch[2] == epoch.z &&
+           header->epoch[3] == epoch.vr && header->epoch[4] == epoch.vtheta && header->epoch[5] == epoch.vz &&
+           header->startTime <= startTime && header->endTime >= endTime;
+}
+
+elements<double> ChebyshevEphemeris::getCondition(const double & time) {
+    double t = time;
+    if (t < header->startTime) {
+        t = header->startTime;
+    }
+    else if (t > header->endTime) {
+        t = header->endTime;
+    }
+
+    // Segment containing t, the last one for endTime itself
+    int64_t segment = static_cast<int64_t>((t - header->startTime)/header->segmentLength);
+    if (segment > header->segmentCount - 1) {
+        segment = header->segmentCount - 1;
+    }
+
+    double x = 2*(t - header->startTime - segment*header->segmentLength)/header->segmentLength - 1;
+    return clenshaw(coeff + segment*(header->degree + 1)*6, header->degree, x);
+}
+
+const ephemerisHeader * ChebyshevEphemeris::getHeader() {
+    return header;
+}
@@ -0,0 +1,82 @@
+#ifndef EPHEMERIS_H
+#define EPHEMERIS_H
+
+#include <string>  // for file names
+#include <cstdint> // for uint32_t and int64_t
+#include "earthCache.h" // for MappedFile
+
+// Version of the ephemeris file layout
+#define EPHEMERIS_VERSION 1
+// Highest polynomial degree an ephemeris file can use
+#define EPHEMERIS_MAX_DEGREE 31
+
+// Start of a Chebyshev ephemeris file, followed by segmentCount*(degree+1)*6 doubles: for each segment, for each Chebyshev
+// order k from 0 to degree, the coefficients of r, theta, z, vr, vtheta, and vz in that order
+// Times are offsets from impact backwards in time (s) as in EarthInfo, theta is unwrapped (continuous past 2 pi)
+// Kept at 96 bytes so the coefficients after it stay aligned when the file is mapped
+struct ephemerisHeader {
+    char magic[8];        // "CHEBEPHM"
+    uint32_t version;     // EPHEMERIS_VERSION
+    uint32_t degree;      // degree of every segment's polynomials
+    int64_t segmentCount; // number of segments
+    double startTime;     // time at the start of the first segment (s)
+    double endTime;       // time at the end of the last segment (s)
+    double segmentLength; // length of every segment (s)
+    double epoch[6];      // the body's r, theta, z, vr, vtheta, vz at impact that the file was propagated from
+};
+
+// Position of the j'th Chebyshev-Gauss node of a degree polynomial, from near 1 (j = 0) to near -1 (j = degree)
+double chebyshevNode(const int & j, const int & degree);
+
+// Chebyshev coefficients of one segment from the values at its nodes
+// Input: values - degree+1 values, values[j] at chebyshevNode(j, degree) of the segment
+// Output: coeff is set to the (degree+1)*6 coefficients in the file's order
+void fitChebyshev(const elements<double> values[], const int & degree, double coeff[]);
+
+// Evaluates one segment's six polynomials together with Clenshaw's recurrence, the six elements are updated in one inner loop
+// Input: coeff - (degree+1)*6 coefficients in the file's order, x - position in the segment from -1 (start) to 1 (end)
+// Output: returns the elements at x
+elements<double> clenshaw(const double coeff[], const int & degree, const double & x);
+
+// Fits segments to a body's path by propagating it backwards from impact with rk4Reverse(), node to node
+// Input: epoch - the body's conditions at impact
+//        startTime, endTime - time range to cover (s), the segments start at startTime and the last one ends at or after endTime
+//        segmentLength - length of each segment (s)
+//        degree - degree of the polynomials (1 to EPHEMERIS_MAX_DEGREE)
+//        cConstants - rk_tol and the step limits for rk4Reverse()
+// Output: header is filled in, returns the coefficients (segmentCount*(degree+1)*6 doubles, to be deleted by the caller)
+double * buildEphemeris(const elements<double> & epoch, const double & startTime, const double & endTime, const double & segmentLength, const int & degree,
+                        const cudaConstants* cConstants, ephemerisHeader & header);
+
+// Writes an ephemeris file
+// Output: returns false if the file could not be written
+bool writeEphemeris(const std::string & fileName, const ephemerisHeader & header, const double * coeff);
+
+// Ephemeris file mapped into memory and evaluated from its coefficients
+class ChebyshevEphemeris {
+    private:
+        MappedFile file;
+        const ephemerisHeader *header; // start of the file, nullptr if no file is open
+        const double *coeff;           // coefficients following the header
+
+    public:
+        ChebyshevEphemeris();
+
+        // Maps fileName, returns false (leaving nothing open) if it could not be mapped or is not a valid ephemeris file
+        bool open(const std::string & fileName);
+
+        // Unmaps the file, if one is open
+        void close();
+
+        // Returns true if the open file was propagated from epoch and covers startTime to endTime
+        bool covers(const elements<double> & epoch, const double & startTime, const double & endTime);
+
+        // Returns the body's conditions at time (offset from impact backwards in time, s), times outside of the file are clamped to its nearest end
+        elements<double> getCondition(const double & time);
+
+        // Returns the open file's header, nullptr if no file is open
+        const ephemerisHeader * getHeader();
+};
+
+#include "ephemeris.cpp"
+#endif
@@ -0,0 +1,22 @@
+// Weyl sequence increment of SplitMix64, 2^64 divided by the golden ratio
+#define SPLITMIX_GAMMA 0x9E3779B97F4A7C15ULL
+
+uint64_t splitMix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+counterRng::counterRng(const uint64_t & seed, const uint64_t & generation, const uint64_t & index, const int & purpose) {
+    // Each key value is mixed in turn so streams differing in any one of them are unrelated
+    key = splitMix64(seed + SPLITMIX_GAMMA);
+    key = splitMix64(key ^ (generation + SPLITMIX_GAMMA));
+    key = splitMix64(key ^ (index + SPLITMIX_GAMMA));
+    key = splitMix64(key ^ (static_cast<uint64_t>(purpose) + SPLITMIX_GAMMA));
+    counter = 0;
+}
+
+uint64_t counterRng::operator()() {
+    counter++;
+    return splitMix64(key + counter*SPLITMIX_GAMMA);
+}
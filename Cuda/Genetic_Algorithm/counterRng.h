@@ -0,0 +1,39 @@
+#ifndef COUNTERRNG_H
+#define COUNTERRNG_H
+
+#include <cstdint> // for uint64_t
+
+// What a counterRng stream is used for, so the streams for different uses with the same key never overlap
+enum RNG_PURPOSE {
+    RNG_MUTATE = 0,  // crossover and mutation of one child, keyed by the child's index
+    RNG_MASK = 1,    // crossover mask shared by a pair of children, keyed by the pair's first child index
+    RNG_SHUFFLE = 2  // shuffle of the survivors at the start of newGeneration()
+};
+
+// SplitMix64 output function, mixes the bits of x into a well distributed 64 bit value
+uint64_t splitMix64(uint64_t x);
+
+// Counter based random number generator, the n'th number of a stream is splitMix64 of the stream's key plus n times a constant
+// A stream is keyed by (seed, generation, index, purpose) and has no other state, so what a child of a generation draws
+// does not depend on which thread makes it or in what order, and children can be made in parallel with bit-identical results
+// Meets the UniformRandomBitGenerator requirements, so it can be used with std::shuffle
+class counterRng {
+    private:
+        uint64_t key;     // hash of the stream's key values
+        uint64_t counter; // numbers drawn so far
+
+    public:
+        typedef uint64_t result_type;
+
+        // Input: seed - time_seed of the run, generation - current generation, index - child (or pair) index, purpose - an RNG_PURPOSE
+        counterRng(const uint64_t & seed, const uint64_t & generation, const uint64_t & index, const int & purpose);
+
+        // Returns the next number of the stream
+        uint64_t operator()();
+
+        static constexpr uint64_t min() { return 0; }
+        static constexpr uint64_t max() { return UINT64_MAX; }
+};
+
+#include "counterRng.cpp"
+#endif
@@ -0,0 +1,205 @@
+#include <cmath>   // for frexp(), ldexp(), and round()
+#include <cstring> // for memcpy()
+
+FitnessCache::FitnessCache(const cudaConstants* cConstants, int poolSize) {
+    uint64_t slots = 1;
+    while (slots < static_cast<uint64_t>(cConstants->fitness_cache_size)) {
+        slots *= 2;
+    }
+    slotMask = slots - 1;
+
+    entries = new fitnessEntry[slots];
+    for (uint64_t i = 0; i < slots; i++) {
+        entries[i].hash = 0;
+        entries[i].pending = -1;
+        entries[i].lastUsed = -1;
+    }
+
+    // Keep enough significant bits for the relative tolerance, 52 or more is the same as not rounding
+    mantissaBits = 0;
+    if (cConstants->fitness_cache_tol > 0) {
+        mantissaBits = static_cast<int>(std::ceil(-std::log2(cConstants->fitness_cache_tol)));
+        if (mantissaBits < 1) {
+            mantissaBits = 1;
+        }
+        if (mantissaBits >= 52) {
+            mantissaBits = 0;
+        }
+    }
+
+    toEvaluate = new Individual[poolSize];
+    evaluateSlot = new int[poolSize];
+    source = new int[poolSize];
+
+    stats.lookups = stats.hits = stats.repeats = stats.evaluated = 0;
+    totals = stats;
+}
+
+double FitnessCache::quantize(const double & value) {
+    if (mantissaBits == 0 || value == 0 || !std::isfinite(value)) {
+        return value;
+    }
+    // value = m * 2^exponent with 0.5 <= |m| < 1, keep mantissaBits bits of m
+    int exponent;
+    double m = std::frexp(value, &exponent);
+    return std::ldexp(std::round(std::ldexp(m, mantissaBits)), exponent - mantissaBits);
+}
+
+void FitnessCache::genomeOf(const rkParameters<double> & params, double genome[]) {
+    for (int j = 0; j < params.coeff.gammaSize; j++) {
+        genome[GAMMA_OFFSET + j] = quantize(params.coeff.gamma[j]);
+    }
+    for (int j = 0; j < params.coeff.tauSize; j++) {
+        genome[TAU_OFFSET + j] = quantize(params.coeff.tau[j]);
+    }
+    for (int j = 0; j < params.coeff.coastSize; j++) {
+        genome[COAST_OFFSET + j] = quantize(params.coeff.coast[j]);
+    }
+    genome[TRIPTIME_OFFSET] = quantize(params.tripTime);
+    genome[ALPHA_OFFSET] = quantize(params.alpha);
+    genome[BETA_OFFSET] = quantize(params.beta);
+    genome[ZETA_OFFSET] = quantize(params.zeta);
+}
+
+uint64_t FitnessCache::hashGenome(const double genome[]) {
+    uint64_t hash = SPLITMIX_GAMMA;
+    for (int i = 0; i < OPTIM_VARS; i++) {
+        uint64_t bits;
+        memcpy(&bits, &genome[i], sizeof(bits));
+        hash = splitMix64(hash ^ bits);
+    }
+    return (hash == 0) ? 1 : hash;
+}
+
+int FitnessCache::find(const uint64_t & hash, const double genome[]) {
+    for (int p = 0; p < FITNESS_CACHE_PROBES; p++) {
+        int slot = static_cast<int>((hash + p) & slotMask);
+        if (entries[slot].hash == hash) {
+            bool same = true;
+            for (int i = 0; i < OPTIM_VARS && same; i++) {
+                same = (entries[slot].genome[i] == genome[i]);
+            }
+            if (same) {
+                return slot;
+            }
+        }
+    }
+    return -1;
+}
+
+int FitnessCache::claim(const uint64_t & hash) {
+    int best = static_cast<int>(hash & slotMask);
+    for (int p = 0; p < FITNESS_CACHE_PROBES; p++) {
+        int slot = static_cast<int>((hash + p) & slotMask);
+        if (entries[slot].hash == 0) {
+            return slot;
+        }
+        if (entries[slot].lastUsed < entries[best].lastUsed) {
+            best = slot;
+        }
+    }
+    return best;
+}
+
+int FitnessCache::lookup(Individual *individuals, int count, double generation) {
+    stats.lookups = count;
+    stats.hits = stats.repeats = 0;
+    int evaluateCount = 0;
+
+    double genome[OPTIM_VARS];
+    for (int i = 0; i < count; i++) {
+        genomeOf(individuals[i].startParams, genome);
+        uint64_t hash = hashGenome(genome);
+        int slot = find(hash, genome);
+
+        if (slot >= 0 && entries[slot].pending < 0) {
+            // Already evaluated
+            individuals[i].finalPos = entries[slot].finalPos;
+            individuals[i].posDiff = entries[slot].posDiff;
+            individuals[i].velDiff = entries[slot].velDiff;
+            individuals[i].cost = entries[slot].cost;
+            individuals[i].prunedTime = 0;
+            entries[slot].lastUsed = generation;
+            source[i] = -1;
+            stats.hits++;
+        }
+        else if (slot >= 0) {
+            // Same as an earlier individual of this generation, use its evaluation
+            source[i] = entries[slot].pending;
+            stats.repeats++;
+        }
+        else {
+            // New genome, evaluate it and hold a slot for the result
+            slot = claim(hash);
+            if (entries[slot].pending >= 0) {
+                // Replacing a slot another individual of this generation was going to fill
+                evaluateSlot[entries[slot].pending] = -1;
+            }
+            entries[slot].hash = hash;
+            memcpy(entries[slot].genome, genome, sizeof(genome));
+            entries[slot].pending = evaluateCount;
+            entries[slot].lastUsed = generation;
+
+            toEvaluate[evaluateCount] = individuals[i];
+            evaluateSlot[evaluateCount] = slot;
+            source[i] = evaluateCount;
+            evaluateCount++;
+        }
+    }
+
+    stats.evaluated = evaluateCount;
+
+    totals.lookups += stats.lookups;
+    totals.hits += stats.hits;
+    totals.repeats += stats.repeats;
+    totals.evaluated += stats.evaluated;
+    return evaluateCount;
+}
+
+Individual * FitnessCache::getToEvaluate() {
+    return toEvaluate;
+}
+
+void FitnessCache::store(Individual *individuals, int count, const bool * inexact) {
+    for (int e = 0; e < stats.evaluated; e++) {
+        int slot = evaluateSlot[e];
+        if (slot >= 0 && (toEvaluate[e].prunedTime > 0 || (inexact != nullptr && inexact[e]))) {
+            // lookup() scans every probe, so an emptied slot does not hide the entries after it
+            entries[slot].hash = 0;
+            entries[slot].pending = -1;
+            entries[slot].lastUsed = -1;
+        }
+        else if (slot >= 0) {
+            entries[slot].finalPos = toEvaluate[e].finalPos;
+            entries[slot].posDiff = toEvaluate[e].posDiff;
+            entries[slot].velDiff = toEvaluate[e].velDiff;
+            entries[slot].cost = toEvaluate[e].cost;
+            entries[slot].pending = -1;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (source[i] >= 0) {
+            individuals[i].finalPos = toEvaluate[source[i]].finalPos;
+            individuals[i].posDiff = toEvaluate[source[i]].posDiff;
+            individuals[i].velDiff = toEvaluate[source[i]].velDiff;
+            individuals[i].cost = toEvaluate[source[i]].cost;
+            individuals[i].prunedTime = toEvaluate[source[i]].prunedTime;
+        }
+    }
+}
+
+fitnessCacheStats FitnessCache::getStats() {
+    return stats;
+}
+
+fitnessCacheStats FitnessCache::getTotals() {
+    return totals;
+}
+
+FitnessCache::~FitnessCache() {
+    delete [] entries;
+    delete [] toEvaluate;
+    delete [] evaluateSlot;
+    delete [] source;
+}
@@ -0,0 +1,102 @@
+#ifndef FITNESSCACHE_H
+#define FITNESSCACHE_H
+
+#include <cstdint>      // for uint64_t
+#include "counterRng.h" // for splitMix64(), used to hash genomes
+
+// Number of slots checked from where a genome hashes to, the least recently used of them is replaced when none are free
+#define FITNESS_CACHE_PROBES 8
+
+// Evaluated result of one genome
+struct fitnessEntry {
+    uint64_t hash;              // hash of genome, 0 if the slot is empty
+    double genome[OPTIM_VARS];  // the genome in OPTIM_VARS order (GAMMA_OFFSET etc.), quantized when fitness_cache_tol is set
+    elements<double> finalPos;  // results of the evaluation
+    double posDiff;
+    double velDiff;
+    double cost;
+    int pending;       // index in the evaluation list of the individual that will fill this entry, -1 once it has been filled
+    double lastUsed;   // generation the entry was last stored or found, the least recently used slot is replaced
+};
+
+// Counts for the last lookup() made
+struct fitnessCacheStats {
+    int lookups;   // new individuals looked up
+    int hits;      // found already evaluated in the cache
+    int repeats;   // the same as another new individual of this generation, evaluated once for both
+    int evaluated; // left to be evaluated
+};
+
+// Hash table of evaluated genomes, used to skip the Runge Kutta integration of children that repeat an earlier genome
+// (crossOver_average of identical parents, unmutated copies of a parent, flipped masks giving the same child)
+// The genome is the OPTIM_VARS optimized values: gamma, tau, and coast coefficients, alpha, beta, zeta, and tripTime,
+// everything else an evaluation depends on is the same for the whole run
+// Exact by default, the results are the same as evaluating again
+// With fitness_cache_tol set each value is rounded to that relative precision first, so near duplicates share the result
+// of the first one evaluated
+// All memory is allocated by the constructor, the table has fitness_cache_size slots rounded up to a power of two
+class FitnessCache {
+    private:
+        fitnessEntry *entries;
+        uint64_t slotMask;  // number of slots - 1
+        int mantissaBits;   // significant bits kept by quantize(), 0 if the genomes are not rounded
+
+        // Lists for the generation being evaluated, each poolSize long
+        Individual *toEvaluate; // copies of the new individuals that need to be evaluated
+        int *evaluateSlot;      // slot in entries each individual in toEvaluate fills, -1 if it was replaced before it was filled
+        int *source;            // for each new individual, the index in toEvaluate it gets its results from, -1 if found in the cache
+
+        fitnessCacheStats stats;  // counts for the last lookup()
+        fitnessCacheStats totals; // counts for every lookup() so far
+
+        // Genome of an individual in OPTIM_VARS order, rounded by quantize()
+        void genomeOf(const rkParameters<double> & params, double genome[]);
+
+        // Rounds value to mantissaBits significant bits, unchanged if mantissaBits is 0
+        double quantize(const double & value);
+
+        // Hash of a genome, never 0 so 0 can mark an empty slot
+        uint64_t hashGenome(const double genome[]);
+
+        // Returns the slot holding genome, -1 if it is not in the table
+        int find(const uint64_t & hash, const double genome[]);
+
+        // Returns the slot to store a new genome in, an empty one or the least recently used
+        int claim(const uint64_t & hash);
+
+    public:
+        // Allocates the table and the lists
+        // Input: cConstants - fitness_cache_size and fitness_cache_tol
+        //        poolSize - most individuals a generation can look up
+        FitnessCache(const cudaConstants* cConstants, int poolSize);
+
+        // Looks up new individuals, copying in the results of genomes that have already been evaluated
+        // Input: individuals - count new individuals, with startParams set
+        //        generation - current generation, used to choose which entries to replace
+        // Output: individuals found in the cache have finalPos, posDiff, velDiff, and cost set
+        //         the rest (one of each genome that repeats within individuals) are copied to getToEvaluate(), returns how many
+        int lookup(Individual *individuals, int count, double generation);
+
+        // The individuals lookup() found need to be evaluated
+        Individual * getToEvaluate();
+
+        // Stores the results of the evaluated individuals and copies them to the individuals of the last lookup()
+        // Input: individuals, count - same as the last lookup(), getToEvaluate() has been evaluated
+        //        inexact - for each of getToEvaluate(), true if its results are only approximate (such as a FitnessScreen coarse pass)
+        //                  and should not be kept, nullptr if they are all exact
+        // Output: every one of individuals has finalPos, posDiff, velDiff, cost, and prunedTime set
+        //         the slots claimed for inexact or pruned results are emptied, so those genomes are evaluated again if they come back
+        void store(Individual *individuals, int count, const bool * inexact = nullptr);
+
+        // Counts for the last lookup()
+        fitnessCacheStats getStats();
+
+        // Counts added up over every lookup() made
+        fitnessCacheStats getTotals();
+
+        // Frees the table and lists
+        ~FitnessCache();
+};
+
+#include "fitnessCache.cpp"
+#endif
@@ -0,0 +1,204 @@
+#include <algorithm> // for std::nth_element and std::sort
+#include <cmath>     // for isnan(), fabs(), and INFINITY
+
+FitnessScreen::FitnessScreen(const cudaConstants* cConstants, int poolSize) : coarse(*cConstants) {
+    coarse.max_numsteps = cConstants->screen_max_numsteps;
+    if (coarse.min_numsteps > coarse.max_numsteps) {
+        coarse.min_numsteps = coarse.max_numsteps;
+    }
+    if (cConstants->screen_tol > 0) {
+        coarse.rk_tol = cConstants->screen_tol;
+    }
+    margin = cConstants->screen_margin;
+    posError = velError = INFINITY;
+
+    selectionSize = cConstants->survivor_count;
+    posCount = static_cast<int>(selectionSize * cConstants->survivorRatio);
+    if (posCount > selectionSize) {
+        posCount = selectionSize;
+    }
+
+    refine = new Individual[poolSize];
+    refineIndex = new int[poolSize];
+    coarsePosDiff = new double[poolSize];
+    coarseVelDiff = new double[poolSize];
+    screenedOut = new bool[poolSize];
+    // Room for the kept individuals plus the new ones
+    keys = new rankKey[2 * poolSize];
+    coarseRank = new int[poolSize];
+
+    posBound = velBound = 0;
+    stats.screened = stats.refined = stats.selectionChanges = stats.rankChanges = 0;
+    stats.maxPosDiffError = stats.maxVelDiffError = 0;
+    totals = stats;
+}
+
+const cudaConstants * FitnessScreen::getCoarseConstants() {
+    return &coarse;
+}
+
+double FitnessScreen::kthKey(int n, int k) {
+    std::nth_element(keys, keys + (k - 1), keys + n);
+    return keys[k - 1].key;
+}
+
+bool FitnessScreen::inSurvivors(const double & posDiff, const double & velDiff) {
+    return posDiff <= posBound || velDiff >= velBound;
+}
+
+int FitnessScreen::chooseRefine(const Individual *kept, int keptCount, const Individual *screened, int count) {
+    int n = keptCount + count;
+
+    // posDiff of the last survivor chosen by posDiff, no posDiff survivors can be chosen if posCount is 0
+    // NaN results (cut off near the sun) are refined below, they are ranked last here so the keys can be ordered
+    posBound = -INFINITY;
+    if (posCount > 0) {
+        for (int i = 0; i < keptCount; i++) {
+            keys[i].key = isnan(kept[i].posDiff) ? INFINITY : kept[i].posDiff;
+            keys[i].index = i;
+        }
+        for (int i = 0; i < count; i++) {
+            keys[keptCount + i].key = isnan(screened[i].posDiff) ? INFINITY : screened[i].posDiff;
+            keys[keptCount + i].index = keptCount + i;
+        }
+        posBound = (posCount < n) ? kthKey(n, posCount) : INFINITY;
+    }
+
+    // velDiff of the last survivor chosen by velDiff (higher velDiff first), they are ranked up to selectionSize
+    velBound = INFINITY;
+    if (posCount < selectionSize) {
+        for (int i = 0; i < keptCount; i++) {
+            keys[i].key = isnan(kept[i].velDiff) ? INFINITY : -kept[i].velDiff;
+            keys[i].index = i;
+        }
+        for (int i = 0; i < count; i++) {
+            keys[keptCount + i].key = isnan(screened[i].velDiff) ? INFINITY : -screened[i].velDiff;
+            keys[keptCount + i].index = keptCount + i;
+        }
+        velBound = (selectionSize < n) ? -kthKey(n, selectionSize) : -INFINITY;
+    }
+
+    // The boundary found from coarse results can itself be off by the error, so anything within twice the error of it
+    // could be a survivor once integrated accurately (an infinite boundary with an infinite error is NaN, so never close)
+    double posReach = posBound + 2 * margin * posError;
+    double velReach = velBound - 2 * margin * velError;
+    int refineCount = 0;
+    for (int i = 0; i < count; i++) {
+        const Individual & ind = screened[i];
+        bool close = (ind.posDiff <= posReach) || (ind.velDiff >= velReach);
+        if (close || isnan(ind.posDiff) || isnan(ind.velDiff)) {
+            refine[refineCount] = ind;
+            refineIndex[refineCount] = i;
+            coarsePosDiff[refineCount] = ind.posDiff;
+            coarseVelDiff[refineCount] = ind.velDiff;
+            refineCount++;
+            screenedOut[i] = false;
+        }
+        else {
+            screenedOut[i] = true;
+        }
+    }
+
+    stats.screened = count;
+    stats.refined = refineCount;
+    return refineCount;
+}
+
+Individual * FitnessScreen::getRefine() {
+    return refine;
+}
+
+void FitnessScreen::finishRefine(Individual *screened) {
+    stats.selectionChanges = 0;
+    stats.rankChanges = 0;
+    stats.maxPosDiffError = 0;
+    stats.maxVelDiffError = 0;
+    int measured = 0; // refined individuals the errors were measured on
+
+    for (int r = 0; r < stats.refined; r++) {
+        Individual & ind = screened[refineIndex[r]];
+        ind.finalPos = refine[r].finalPos;
+        ind.posDiff = refine[r].posDiff;
+        ind.velDiff = refine[r].velDiff;
+        ind.cost = refine[r].cost;
+        bool pruned = (ind.prunedTime > 0 || refine[r].prunedTime > 0);
+        ind.prunedTime = refine[r].prunedTime;
+
+        if (inSurvivors(coarsePosDiff[r], coarseVelDiff[r]) != inSurvivors(ind.posDiff, ind.velDiff)) {
+            stats.selectionChanges++;
+        }
+        // NaN results (which optimize() replaces) and pruned results (bounds, not values) are left out of the errors
+        if (pruned) {
+            continue;
+        }
+        measured++;
+        double error = fabs(coarsePosDiff[r] - ind.posDiff);
+        if (error > stats.maxPosDiffError) {
+            stats.maxPosDiffError = error;
+        }
+        error = fabs(coarseVelDiff[r] - ind.velDiff);
+        if (error > stats.maxVelDiffError) {
+            stats.maxVelDiffError = error;
+        }
+    }
+    if (measured > 0) {
+        posError = stats.maxPosDiffError;
+        velError = stats.maxVelDiffError;
+    }
+
+    // Place of each refined individual by coarse and by final posDiff, among those with both results (NaN cannot be ordered)
+    int ranked = 0;
+    for (int r = 0; r < stats.refined; r++) {
+        if (!isnan(coarsePosDiff[r]) && !isnan(refine[r].posDiff)) {
+            keys[ranked].key = coarsePosDiff[r];
+            keys[ranked].index = r;
+            ranked++;
+        }
+    }
+    std::sort(keys, keys + ranked);
+    for (int p = 0; p < ranked; p++) {
+        coarseRank[keys[p].index] = p;
+    }
+    for (int p = 0; p < ranked; p++) {
+        keys[p].key = refine[keys[p].index].posDiff;
+    }
+    std::sort(keys, keys + ranked);
+    for (int p = 0; p < ranked; p++) {
+        if (coarseRank[keys[p].index] != p) {
+            stats.rankChanges++;
+        }
+    }
+
+    totals.screened += stats.screened;
+    totals.refined += stats.refined;
+    totals.selectionChanges += stats.selectionChanges;
+    totals.rankChanges += stats.rankChanges;
+    if (stats.maxPosDiffError > totals.maxPosDiffError) {
+        totals.maxPosDiffError = stats.maxPosDiffError;
+    }
+    if (stats.maxVelDiffError > totals.maxVelDiffError) {
+        totals.maxVelDiffError = stats.maxVelDiffError;
+    }
+}
+
+const bool * FitnessScreen::getScreenedOut() {
+    return screenedOut;
+}
+
+screenStats FitnessScreen::getStats() {
+    return stats;
+}
+
+screenStats FitnessScreen::getTotals() {
+    return totals;
+}
+
+FitnessScreen::~FitnessScreen() {
+    delete [] refine;
+    delete [] refineIndex;
+    delete [] coarsePosDiff;
+    delete [] coarseVelDiff;
+    delete [] screenedOut;
+    delete [] keys;
+    delete [] coarseRank;
+}
@@ -0,0 +1,93 @@
+#ifndef FITNESSSCREEN_H
+#define FITNESSSCREEN_H
+
+#include "ga_crossover.h" // for rankKey
+
+// Counts for the last generation screened
+struct screenStats {
+    int screened;           // new individuals given the coarse integration
+    int refined;            // of those, integrated again with the full config
+    int selectionChanges;   // refined individuals the coarse result put on the other side of a survivor boundary than the final result
+    int rankChanges;        // refined individuals whose place by posDiff among the refined individuals changed, those with a NaN result are not ranked
+    double maxPosDiffError; // largest difference between the coarse and final posDiff of the refined individuals (AU)
+    double maxVelDiffError; // largest difference between the coarse and final velDiff of the refined individuals (AU/s)
+};
+
+// Two stage evaluation of new individuals, used when screen_max_numsteps is set
+// Every new individual is first integrated with a copy of the config using max_numsteps = screen_max_numsteps (and rk_tol = screen_tol if set),
+// then only those whose coarse posDiff or velDiff could be past the survivor boundaries are integrated again with the full config
+// The boundaries are the posDiff and velDiff of the last survivor selectSurvivors() would choose, counting the kept individuals
+// (exact results) and the new ones (coarse results)
+// How far past them a coarse result can be is the largest coarse error measured on the last generation's refined individuals
+// times screen_margin, until there is a measurement every individual is refined
+// Individuals that are not refined keep their coarse results, they are too far from being selected for the difference to matter,
+// and are not stored in the fitness cache
+// All memory is allocated by the constructor
+class FitnessScreen {
+    private:
+        cudaConstants coarse; // config used for the coarse pass
+        double margin;        // screen_margin
+        double posError;      // largest posDiff and velDiff error of the coarse pass measured on the last refined individuals, INFINITY before any
+        double velError;
+        int posCount;         // survivors chosen by posDiff, as in selectSurvivors()
+        int selectionSize;    // survivor_count
+
+        // Lists for the generation being screened, each poolSize long
+        Individual *refine;    // copies of the individuals to integrate again
+        int *refineIndex;      // index in the screened list of each individual in refine
+        double *coarsePosDiff; // coarse posDiff and velDiff of each individual in refine
+        double *coarseVelDiff;
+        bool *screenedOut;     // for each screened individual, true if it only has its coarse result
+        rankKey *keys;         // scratch for finding the boundaries and ranks
+        int *coarseRank;       // place of each refined individual by coarse posDiff
+
+        double posBound; // posDiff of the last posDiff survivor, from chooseRefine()
+        double velBound; // velDiff of the last velDiff survivor
+
+        screenStats stats;  // counts for the last generation
+        screenStats totals; // counts added up over every generation, the errors are the largest of any generation
+
+        // Returns the k'th lowest key (1 is the lowest) of the first n in keys, reorders keys
+        double kthKey(int n, int k);
+
+        // True if the results are inside the survivor boundaries
+        bool inSurvivors(const double & posDiff, const double & velDiff);
+
+    public:
+        // Input: cConstants - copied for the coarse pass with screen_max_numsteps and screen_tol, screen_margin, survivor_count, and survivorRatio
+        //        poolSize - most individuals a generation can screen
+        FitnessScreen(const cudaConstants* cConstants, int poolSize);
+
+        // The config to integrate the coarse pass with
+        const cudaConstants * getCoarseConstants();
+
+        // Chooses which screened individuals are integrated again
+        // Input: kept, keptCount - the individuals kept from the last generation, with exact results
+        //        screened, count - new individuals with coarse results
+        // Output: the ones that could be survivors are copied to getRefine(), returns how many
+        int chooseRefine(const Individual *kept, int keptCount, const Individual *screened, int count);
+
+        // The individuals chooseRefine() picked, to be evaluated with the full config
+        Individual * getRefine();
+
+        // Copies the refined results back and counts how often they disagree with the coarse ones
+        // Input: screened - same as chooseRefine(), getRefine() has been evaluated
+        // Output: the refined individuals in screened have their final results, getStats() is updated
+        //         the coarse errors measured become the margin for the next chooseRefine()
+        void finishRefine(Individual *screened);
+
+        // For each individual of the last chooseRefine(), true if it only has its coarse result
+        const bool * getScreenedOut();
+
+        // Counts for the last generation
+        screenStats getStats();
+
+        // Counts added up over every generation
+        screenStats getTotals();
+
+        // Frees the lists
+        ~FitnessScreen();
+};
+
+#include "fitnessScreen.cpp"
+#endif
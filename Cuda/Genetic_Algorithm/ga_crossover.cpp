@@ -10,28 +10,38 @@ enum maskValue {
     AVG,
 };
 
+bool operator<(const rankKey & a, const rankKey & b) {
+    if (a.key != b.key) {
+        return a.key < b.key;
+    }
+    return a.index < b.index;
+}
+
 // Determing selection of survivors that will carry properties into the new individuals of the newGeneration
-void selectSurvivors(Individual * pool, int poolSize, int selectionSize, Individual* survivors, const double & ratio) {
-    // Sort the pool by position difference
-    // and assign the first part of the survivor array for best posDiff individuals
+void selectSurvivors(Individual * pool, int selectionSize, Individual* survivors, const double & ratio, const rankKey * posOrder, const rankKey * velOrder) {
+    // Number of survivors chosen by position difference
+    // Truncated, as the velDiff survivors have always started at int(selectionSize*ratio)
+    int posCount = static_cast<int>(selectionSize*ratio);
+    if (posCount > selectionSize) {
+        posCount = selectionSize;
+    }
+
+    // Assign the first part of the survivor array for best posDiff individuals
     // portion size based on the ratio percentage
-    std::sort(pool, pool+poolSize, BetterPosDiff);
-    //Select survivors (starting at 0)
-    for (int i = 0; i < selectionSize*ratio; i++) {
-        survivors[i] = pool[i];
+    for (int i = 0; i < posCount; i++) {
+        survivors[i] = pool[posOrder[i].index];
     }
 
-    // Sort the pool by velocity difference
-    std::sort(pool, pool+poolSize, BetterVelDiff);
-    //starting where first loop ended
-    for (int i = selectionSize*ratio; i < selectionSize; i++) {
-        survivors[(i)] = pool[i];
+    // Then by velocity difference, higher velDiff first
+    //starting where first loop ended, so these are the ranks after posCount
+    for (int i = posCount; i < selectionSize; i++) {
+        survivors[i] = pool[velOrder[i].index];
     }
     return;
 }
 
 // Creates a random bifurcation mask, currently not in use
-void crossOver_randHalf(int * mask, std::mt19937_64 & rng) {
+void crossOver_randHalf(int * mask, counterRng & rng) {
     int crossIndex = rng() % (OPTIM_VARS-1);
     //cout << "Random Index: " << crossIndex << endl;
     for (int i = 0; i < OPTIM_VARS; i++) {
@@ -55,7 +65,7 @@ void crossOver_oneParent(int * mask) {
 }
 
 // Creates a random mask
-void crossOver_wholeRandom(int * mask, std::mt19937_64 & rng) {
+void crossOver_wholeRandom(int * mask, counterRng & rng) {
     for (int i = 0; i < OPTIM_VARS; i++ ) {
         if (rng() % 2) { //Coin flip, either 1/0
             mask[i] = PARTNER2;
@@ -68,7 +78,7 @@ void crossOver_wholeRandom(int * mask, std::mt19937_64 & rng) {
 }
 
 //Generates crossover mask that maintains paramter relationships
-void crossOver_bundleVars(int * mask, std::mt19937_64 & rng) {
+void crossOver_bundleVars(int * mask, counterRng & rng) {
     int p_gamma = 1 + rng() % 2; // partners for each variable are randomly chosen between 1 and 2
     int p_tau = 1 + rng() % 2;
     int p_coast = 1 + rng() % 2;
@@ -131,7 +141,7 @@ void copyMask(int * maskIn, int * maskOut) {
 
 // Utility function for mutate() to get a random double with high resolution
 // The range of the random number is from -max to +max
-double getRand(double max, std::mt19937_64 & rng) {
+double getRand(double max, counterRng & rng) {
     // Example:
     //  rng()/rng.max() is a number between 0 and 1
     //  multipled by two becomes a value between 0 and 2
@@ -141,7 +151,7 @@ double getRand(double max, std::mt19937_64 & rng) {
 }
 
 // Creates a new rkParameters individual by combining properties of two parent Individuals using a mask to determine which
-rkParameters<double> generateNewIndividual(const rkParameters<double> & p1, const rkParameters<double> & p2, const int * mask, const cudaConstants * cConstants, double annealing, std::mt19937_64 & rng, double generation) {
+rkParameters<double> generateNewIndividual(const rkParameters<double> & p1, const rkParameters<double> & p2, const int * mask, const cudaConstants * cConstants, double annealing, counterRng & rng, double generation) {
     // Set the new individual to hold traits from parent 1 
     rkParameters<double> newInd = p1;
 
@@ -215,7 +225,7 @@ rkParameters<double> generateNewIndividual(const rkParameters<double> & p1, cons
 }
 
 // Utility function to generate a boolean mask that determines which parameter value is mutating and how many based on mutation_rate iteratively
-void mutateMask(std::mt19937_64 & rng, bool * mutateMask, double mutation_rate) {
+void mutateMask(counterRng & rng, bool * mutateMask, double mutation_rate) {
     for (int i = 0; i < OPTIM_VARS; i++) {
         //Reset mask
         mutateMask[i] = false;
@@ -241,12 +251,12 @@ void mutateMask(std::mt19937_64 & rng, bool * mutateMask, double mutation_rate)
 }
 
 // In a given Individual's parameters, generate a mutate mask using mutateMask() and then adjust parameters based on the mask, mutation of at least one gene is not guranteed
-rkParameters<double> mutate(const rkParameters<double> & p1, std::mt19937_64 & rng, double annealing, const cudaConstants* cConstants, double generation) {    
+rkParameters<double> mutate(const rkParameters<double> & p1, counterRng & rng, double annealing, const cudaConstants* cConstants, double generation) {    
     // initially set new individual to have all parameter values from parent 1
     rkParameters<double> newInd = p1;
 
     // Declare and set a mutation_mask for which gene is being mutated
-    bool * mutation_mask = new bool[OPTIM_VARS];
+    bool mutation_mask[OPTIM_VARS];
     mutateMask(rng, mutation_mask, cConstants->mutation_rate);
 
     // Declare a record that is to describe what genes are being changed and by how much to record into mutateFile
@@ -324,73 +334,96 @@ rkParameters<double> mutate(const rkParameters<double> & p1, std::mt19937_64 & r
     //     recordMutateFile(cConstants, generation, annealing, genesMutated, recordLog);
     // }
 
-    delete [] mutation_mask;
     return newInd;
 }
 
 
 // Method that creates a pair of new Individuals from a pair of other individuals and a mask
-void generateChildrenPair(Individual *pool, Individual *survivors, int * mask, int& newIndCount, int parentsIndex, double annealing, int poolSize, std::mt19937_64 & rng, const cudaConstants* cConstants, double generation) { 
+void generateChildrenPair(Individual *pool, Individual *survivors, int * mask, const int & newIndCount, int parentsIndex, double annealing, int poolSize, const cudaConstants* cConstants, double generation) { 
     // Determine where the parents and the new individual being created are located in the pool
     int parent1Index = parentsIndex;
     int parent2Index = parentsIndex + 1;
 
     // The new indiviudal is located at the end of the pool
     // up the number of new individuals already created
-    int newIndividualIndex = poolSize - 1 - newIndCount;    
+    int newIndividualIndex = poolSize - 1 - newIndCount;
+    // Each child's random numbers come from its own stream
+    counterRng rng1(static_cast<uint64_t>(cConstants->time_seed), static_cast<uint64_t>(generation), newIndCount, RNG_MUTATE);
     // Generate new offspring with mask
-    pool[newIndividualIndex] = Individual(generateNewIndividual(survivors[parent1Index].startParams, survivors[parent2Index].startParams, mask, cConstants, annealing, rng, generation), cConstants);
-    newIndCount++;
+    // Only the parameters are set here, newGeneration() sets up the new individuals together with initStartPositions()
+    pool[newIndividualIndex].startParams = generateNewIndividual(survivors[parent1Index].startParams, survivors[parent2Index].startParams, mask, cConstants, annealing, rng1, generation);
 
     // Get the opposite offspring from the mask by flipping the mask
-    newIndividualIndex--; // Decrement newIndividualIndex value to access where the next individual must be as newIndCount has increased
+    newIndividualIndex--; // Decrement newIndividualIndex value to access where the next individual must be
+    counterRng rng2(static_cast<uint64_t>(cConstants->time_seed), static_cast<uint64_t>(generation), newIndCount + 1, RNG_MUTATE);
     flipMask(mask);
-    pool[newIndividualIndex] = Individual(generateNewIndividual(survivors[parent1Index].startParams, survivors[parent2Index].startParams, mask, cConstants, annealing, rng, generation), cConstants);
-    newIndCount++;
+    pool[newIndividualIndex].startParams = generateNewIndividual(survivors[parent1Index].startParams, survivors[parent2Index].startParams, mask, cConstants, annealing, rng2, generation);
 
     return;
 }
 
+void generationWorker(int threadId, int numThreads, void* context) {
+    generationJob *job = static_cast<generationJob*>(context);
+
+    //Crossover mask, one per thread
+    int mask[OPTIM_VARS];
+
+    // Pairs of children are numbered in the order the serial loops made them, numPairs with each mask type:
+    // wholeRandom, average, and then two of bundleVars (two seperate sets resulting from carry over of past code)
+    int totalPairs = 4 * job->numPairs;
+    int firstPair = (totalPairs * threadId) / numThreads;
+    int lastPair = (totalPairs * (threadId + 1)) / numThreads;
+
+    for (int p = firstPair; p < lastPair; p++) {
+        int maskType = p / job->numPairs;
+        int i = p % job->numPairs;
+
+        // Every pair needs a unique mask, from the stream of the pair (keyed by its first child)
+        counterRng maskRng(static_cast<uint64_t>(job->cConstants->time_seed), static_cast<uint64_t>(job->generation), 2*p, RNG_MASK);
+        if (maskType == 0) {
+            crossOver_wholeRandom(mask, maskRng);
+        }
+        else if (maskType == 1) {
+            crossOver_average(mask);
+        }
+        else {
+            crossOver_bundleVars(mask, maskRng);
+        }
+        generateChildrenPair(job->pool, job->survivors, mask, 2*p, 2*i, job->annealing, job->poolSize, job->cConstants, job->generation);
+    }
+
+    // Find the starting positions of this thread's new individuals, which are together at the end of the pool
+    // The lookup arrays come from this thread's scratch memory when there is some
+    int childCount = 2 * (lastPair - firstPair);
+    if (childCount > 0) {
+        ScratchArena *arena = nullptr;
+        if (job->arenas != nullptr) {
+            arena = &job->arenas[threadId];
+            arena->reset();
+        }
+        initStartPositions(job->pool + (job->poolSize - 2*lastPair), childCount, job->cConstants, arena);
+    }
+}
+
 // Creates the next pool to be used in the optimize function in opimization.cu
-int newGeneration(Individual *survivors, Individual *pool, int survivorSize, int poolSize, double annealing, const cudaConstants* cConstants, std::mt19937_64 & rng, double generation) {
-    //Crossover mask allocation, used for performance
-    int * mask = new int[OPTIM_VARS];
-    // Number of new individuals created so far (initially none)
-    // used in navigating through the pool when creating new individuals and returned at end of function
-    int newIndCount = 0; 
-    // Value for how many pairs to use and produce in each loop
-    // (as one iteration through a loop produces a new pair)
+int newGeneration(Individual *survivors, Individual *pool, int survivorSize, int poolSize, double annealing, const cudaConstants* cConstants, double generation, ScratchArena *arenas) {
+    // Value for how many pairs of survivors to use, each pair produces four pairs of children
     int numPairs = survivorSize / 2;
 
     // Shuffle the survivors to ensure diverse crossover
-    std::shuffle(survivors, survivors+survivorSize, rng);
+    counterRng shuffleRng(static_cast<uint64_t>(cConstants->time_seed), static_cast<uint64_t>(generation), 0, RNG_SHUFFLE);
+    std::shuffle(survivors, survivors+survivorSize, shuffleRng);
 
     // Generate two offspring through each crossover method
     // total is 4 * survivorSize offspring in pool
-
-    // Every loop needs a unique mask each iteration
-
-    // Loop for wholeRandom mask
-    for (int i = 0; i < numPairs; i++) {
-        crossOver_wholeRandom(mask, rng);
-        generateChildrenPair(pool, survivors, mask, newIndCount, 2*i, annealing, poolSize, rng, cConstants, generation);
+    generationJob job = {survivors, pool, numPairs, poolSize, annealing, cConstants, generation, arenas};
+    if (cpuPool != nullptr) {
+        cpuPool->run(generationWorker, &job);
     }
-    // Loop for averaging mask
-    for (int i = 0; i < numPairs; i++) {
-        crossOver_average(mask);
-        generateChildrenPair(pool, survivors, mask, newIndCount, 2*i, annealing, poolSize, rng, cConstants, generation);
+    else {
+        generationWorker(0, 1, &job);
     }
-    // 2 loops for bundleVars mask,
-    // two seperate loops resulting from carry over of past code
-    // also will allow easier changes in masks used (right now just using two bundleVars instead of two different ones)
-    for (int i = 0; i < numPairs; i++) {
-        crossOver_bundleVars(mask, rng);
-        generateChildrenPair(pool, survivors, mask, newIndCount, 2*i, annealing, poolSize, rng, cConstants, generation);
-    }
-    for (int i = 0; i < numPairs; i++) {
-        crossOver_bundleVars(mask, rng);
-        generateChildrenPair(pool, survivors, mask, newIndCount, 2*i, annealing, poolSize, rng, cConstants, generation);
-    }
-    delete [] mask;
-    return newIndCount;
+
+    // Number of new individuals created
+    return 8 * numPairs;
 }
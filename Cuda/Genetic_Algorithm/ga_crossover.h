@@ -2,16 +2,31 @@
 #define GA_CROSSOVER_H
 
 #include <random>
+#include "counterRng.h" // for counterRng, the random numbers each child is made from
+#include "../Host_Threads/threadPool.h" // for cpuPool, used to make children in parallel
+
+// Sort key of an individual paired with its index in the pool
+// Selection sorts arrays of these rather than moving whole Individuals around, and gathers the individuals at the end
+struct rankKey {
+    double key; // value being sorted on, lower is better
+    int index;  // position of the individual in the pool
+};
+
+// Orders by key, with ties going to the lower index so the order does not depend on how the sort is done
+bool operator<(const rankKey & a, const rankKey & b);
 
 // Method of determing selection of survivors that will carry properties into the new individuals of the newGeneration
 // Called from optimize::optimization.cu
 // Input: pool - (inputParameters) generation of individuals to pull from, no implied order
-//        poolSize - integer number of length of the pool
 //        selectionSize - integer number of how many survivors to choose out of the pool
 //        survivors - pointer array of individuals to promote via crossover / mutate 
-// Output: pool is left sorted by individuals with higher velocity difference
-//         survivors contains an array of size selectionSize of individuals to be used in newGeneration()
-void selectSurvivors(Individual * pool, int poolSize, int selectionSize, Individual* survivors, const double & ratio);
+//        ratio - portion of the survivors that are chosen by posDiff, the rest are by velDiff
+//        posOrder - the pool's (posDiff, index) keys in order, from GenerationEngine::rankGeneration()
+//        velOrder - the pool's (-velDiff, index) keys in order, so higher velocity difference is first as with BetterVelDiff()
+// Output: pool is unchanged
+//         survivors contains an array of size selectionSize of individuals to be used in newGeneration(),
+//         the best posDiff individuals followed by the individuals ranked after them by higher velocity difference
+void selectSurvivors(Individual * pool, int selectionSize, Individual* survivors, const double & ratio, const rankKey * posOrder, const rankKey * velOrder);
 
 ///////////////////////////////////////////////////////////////
 // Crossover Functions                                       //
@@ -35,7 +50,7 @@ void selectSurvivors(Individual * pool, int poolSize, int selectionSize, Individ
 // Creates a random bifurcation mask
 // ** currently not in use - replaced with bundleVars / average **
 // Randomly picks one index to be the start of the '2's from mask
-void crossOver_randHalf(int * mask, std::mt19937_64 & rng);
+void crossOver_randHalf(int * mask, counterRng & rng);
 
 
 // Creates a mask where no mixing occurs
@@ -45,14 +60,14 @@ void crossOver_oneParent(int * mask);
 
 // Creates a mask that is contains randomly chosen values in each index
 // Each element in a mask is randomly set to either PARTNER1 or PARTNER2
-void crossOver_wholeRandom(int * mask, std::mt19937_64 & rng);
+void crossOver_wholeRandom(int * mask, counterRng & rng);
 
 // Generates crossover mask that maintains paramter relationships (gamma, tau, coast values grouped)
 // Similar to crossOver_wholeRandom, but with parameter grouping
 // Input: mask - set, size OPTIM_VARS, 
-//        rng - managed from optimize()
+//        rng - stream for the pair of children the mask is for
 // Output: mask contains values either 1 or 2 (equivalent to PARTNER1 or PARTNER2)
-void crossOver_bundleVars(int * mask, std::mt19937_64 & rng);
+void crossOver_bundleVars(int * mask, counterRng & rng);
 
 // Sets the entire mask to be AVG for length OPTIM_VARS
 // Input: mask - pointer integer array of length OPTIM_VARS
@@ -75,7 +90,7 @@ void copyMask(int * maskIn, int * maskOut);
 // Utility function for mutate() to get a random double with high resolution
 // Input: max - the absolute value of the min and max(min = -max) of the range
 // Output: A double value that is between -max and +max
-double getRand(double max, std::mt19937_64 & rng);
+double getRand(double max, counterRng & rng);
 
 // Creates a new rkParameters individual by combining properties of two parent Individuals using a crossover mask
 // Input: two rkParameter individuals (p1 and p2) - source of genes for new individual
@@ -84,20 +99,20 @@ double getRand(double max, std::mt19937_64 & rng);
 //        cConstants, annealing, rng, generation - passed through to mutate()
 // Output: Returns rkParameter object that is new individual
 // Called from generateChildrenPair, calls mutate
-rkParameters<double> generateNewIndividual(const rkParameters<double> & p1, const rkParameters<double> & p2, const int * mask, const cudaConstants * cConstants, double annealing, std::mt19937_64 & rng, double generation);
+rkParameters<double> generateNewIndividual(const rkParameters<double> & p1, const rkParameters<double> & p2, const int * mask, const cudaConstants * cConstants, double annealing, counterRng & rng, double generation);
 
 // Utility function, generates a boolean mask for which paramters to mutate (1: mutate, 0: not mutated)
 // Number of genes mutated is a compound probability of n-1 genes before it
 // First gene chance is base mutation rate, second chance is after first is mutated
 // chance of mutating n genes = mutation_rate^n
-// input: rng - random number generating object, defined in optimize()
+// input: rng - random number stream of the child being mutated
 //        mutateMask - pointer to a boolean array, length of OPTIM_VARS
 //                   - sets genes being mutated to true and others to false
 //        mutation_rate - a double value less than 1 that is the chance a gene will be mutated
 //                      - called iteratively to mutate more genes
 // output: mutateMask contains false for genes that are not mutating, true for genes that are to be mutated
 // Called by mutate()
-void mutateMask(std::mt19937_64 & rng, bool * mutateMask, double mutation_rate);
+void mutateMask(counterRng & rng, bool * mutateMask, double mutation_rate);
 
 // Handles potential mutation of individual 
 // Calls mutateMask, then applied mutations as necessary
@@ -108,24 +123,41 @@ void mutateMask(std::mt19937_64 & rng, bool * mutateMask, double mutation_rate);
 //        cConstants - holds properties to use such as mutation rates and mutation scales for specific parameter property types
 // Output: Returns rkParameter object that is the mutated version of p1
 // Called by generateNewIndividual
-rkParameters<double> mutate(const rkParameters<double> & p1, std::mt19937_64 & rng, double annealing, const cudaConstants* gConstant, double generation);
+rkParameters<double> mutate(const rkParameters<double> & p1, counterRng & rng, double annealing, const cudaConstants* gConstant, double generation);
 
 // Method that creates a pair of new Individuals from a pair of parent individuals and a mask
 // Input: pool - (output) pointer array to Individuals that is where the new pair of individuals are stored
 //        survivors - (parents) pointer array to Individuals to access the two parents from
 //        mask - pointer array of maskValues used to decide on which property from which parent is acquired (or average of the two)
-//        newIndCount - value that tracks number of newly created indiviudals in the pool so far in the newGeneration process
-//                    - also impacts where to put the new individuals in the pool
+//        newIndCount - number of new individuals created before this pair in the newGeneration process,
+//                      sets where to put the new individuals in the pool and is the child index of the first of them
 //        parentsIndex - value determing where the pair of parent survivors are selected (parent 1 is at parentsIndex, parent 2 is offset by +1)
 //        annealing - double variable passed onto mutateNewIndividual
 //        poolSize - length of the pool array
-//        rng - random number generator passed on to generateNewIndividual
-//        cConstants - passed on to generateNewIndividual
-// Output: pool contains two newly created individuals at (poolSize - 1 - newIndCount) and (poolSize - 2 - newIndCount)
+//        cConstants - passed on to generateNewIndividual, time_seed keys the random number streams
+//        generation - passed on to generateNewIndividual, keys the random number streams
+// Output: pool contains two newly created individuals at (poolSize - 1 - newIndCount) and (poolSize - 2 - newIndCount),
+//         only their startParams are set (newGeneration() finishes setting them up with initStartPositions())
+//         each is made from its own counterRng stream keyed by (time_seed, generation, its child index)
 //         mask is flipped in polarity between each (refer to flipMask method) 
-//         newIndCount is incremented by +2
 // Called by newGeneration()
-void generateChildrenPair(Individual *pool, Individual *survivors, int * mask, int& newIndCount, int parentsIndex, double annealing, int poolSize, std::mt19937_64 & rng, const cudaConstants* cConstants, double generation);
+void generateChildrenPair(Individual *pool, Individual *survivors, int * mask, const int & newIndCount, int parentsIndex, double annealing, int poolSize, const cudaConstants* cConstants, double generation);
+
+// Context for generationWorker(), the values newGeneration() was called with
+struct generationJob {
+    Individual *survivors;
+    Individual *pool;
+    int numPairs;  // pairs of survivors, each pair makes 4 pairs of children
+    int poolSize;
+    double annealing;
+    const cudaConstants *cConstants;
+    double generation;
+    ScratchArena *arenas; // one per thread, nullptr if initStartPositions() allocates its own arrays
+};
+
+// ThreadPool task for newGeneration(), each thread makes an even share of the pairs of children (in one contiguous block)
+// and sets up its children with initStartPositions()
+void generationWorker(int threadId, int numThreads, void* context);
 
 // Creates the next pool to be used in the optimize function in opimization.cu
 // Input: survivors - (parents) Individual pointer array of Individuals to be used in creating new individuals
@@ -133,12 +165,14 @@ void generateChildrenPair(Individual *pool, Individual *survivors, int * mask, i
 //        survivorSize - length of survivors array
 //        poolSize - length of pool array
 //        annealing - passed onto generateChildrenPair
-//        rng - Random number generator to use for making random number values
 //        cConstants - passed onto generateChildrenPair
+//        generation - keys the random number streams with cConstants->time_seed
+//        arenas - scratch memory for each thread of cpuPool (or one when there is no pool), nullptr to allocate what is needed
 // Output: lower (survivorSize * 4) portion of pool is replaced with new individuals
 //         Each parent pair produces 8 new children (4 masks, two children per mask)
+//         The children are made on cpuPool's threads when there is a pool, the result is the same for any number of threads
 //         Returns number of new individuals created (newIndCount)
-int newGeneration(Individual *survivors, Individual *pool, int survivorSize, int poolSize, double annealing, const cudaConstants* cConstants, std::mt19937_64 & rng, double generation );
+int newGeneration(Individual *survivors, Individual *pool, int survivorSize, int poolSize, double annealing, const cudaConstants* cConstants, double generation, ScratchArena *arenas = nullptr);
 
 #include "ga_crossover.cpp"
 #endif
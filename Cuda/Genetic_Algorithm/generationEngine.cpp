@@ -0,0 +1,309 @@
+#include <algorithm> // for std::sort, std::nth_element, and std::merge
+#include <utility>   // for std::swap
+
+// Keys of each ordering, lower is better
+double costKey(const Individual & ind) {
+    return ind.cost;
+}
+double posDiffKey(const Individual & ind) {
+    return ind.posDiff;
+}
+// Higher velDiff first, as with BetterVelDiff()
+double velDiffKey(const Individual & ind) {
+    return -ind.velDiff;
+}
+
+GenerationEngine::GenerationEngine(const cudaConstants* cConstants) {
+    this->cConstants = cConstants;
+    poolSize = cConstants->num_individuals;
+    survivorSize = cConstants->survivor_count;
+    keptCount = poolSize - 8 * (survivorSize / 2);
+    if (keptCount < 0) {
+        keptCount = 0;
+    }
+    // Only the individuals that are kept need to be in order, plus best_count for allWithinTolerance()
+    sortCount = keptCount;
+    if (sortCount < cConstants->best_count) {
+        sortCount = cConstants->best_count;
+    }
+    if (sortCount > poolSize) {
+        sortCount = poolSize;
+    }
+
+    buffers[0] = new Individual[poolSize];
+    buffers[1] = new Individual[poolSize];
+    current = 0;
+
+    survivors = new Individual[survivorSize];
+
+    costOrder = new rankKey[poolSize];
+    posOrder = new rankKey[poolSize];
+    velOrder = new rankKey[poolSize];
+    costSize = posSize = velSize = 0;
+    rankedCount = 0;
+
+    newKeys = new rankKey[poolSize];
+    mergeKeys = new rankKey[poolSize];
+    keptNew = new bool[poolSize];
+    newIndex = new int[poolSize];
+
+    cache = nullptr;
+    if (cConstants->fitness_cache_size > 0) {
+        cache = new FitnessCache(cConstants, poolSize);
+    }
+    lookupCount = 0;
+
+    screen = nullptr;
+    if (cConstants->screen_max_numsteps > 0) {
+        screen = new FitnessScreen(cConstants, poolSize);
+    }
+
+    prune.checkpoints = cConstants->prune_checkpoints;
+    prune.posCutoff = -INFINITY;
+    prune.velCutoff = INFINITY;
+    initPruneThruster(prune, cConstants);
+    pruneReady = false;
+
+    // newGeneration() and callRKCPU() index the arenas by the thread number of cpuPool
+    arenaCount = (cpuPool != nullptr) ? cpuPool->size() : 1;
+    arenas = new ScratchArena[arenaCount];
+}
+
+Individual * GenerationEngine::population() {
+    return buffers[current];
+}
+
+Individual * GenerationEngine::getSurvivors() {
+    return survivors;
+}
+
+const rankKey * GenerationEngine::getPosOrder() {
+    return posOrder;
+}
+
+const rankKey * GenerationEngine::getVelOrder() {
+    return velOrder;
+}
+
+ScratchArena * GenerationEngine::getArenas() {
+    return arenas;
+}
+
+size_t GenerationEngine::scratchBytes() {
+    size_t total = 0;
+    for (int i = 0; i < arenaCount; i++) {
+        total += arenas[i].size();
+    }
+    return total;
+}
+
+int GenerationEngine::findCached(int newInd, double generation) {
+    lookupCount = newInd;
+    if (cache == nullptr) {
+        return newInd;
+    }
+    return cache->lookup(buffers[current] + (poolSize - newInd), newInd, generation);
+}
+
+Individual * GenerationEngine::getToEvaluate() {
+    if (cache == nullptr) {
+        return buffers[current] + (poolSize - lookupCount);
+    }
+    return cache->getToEvaluate();
+}
+
+void GenerationEngine::storeEvaluated() {
+    if (cache != nullptr) {
+        cache->store(buffers[current] + (poolSize - lookupCount), lookupCount, (screen != nullptr) ? screen->getScreenedOut() : nullptr);
+    }
+}
+
+FitnessCache * GenerationEngine::getCache() {
+    return cache;
+}
+
+FitnessScreen * GenerationEngine::getScreen() {
+    return screen;
+}
+
+const pruneBounds * GenerationEngine::getPruneBounds() {
+    return pruneReady ? &prune : nullptr;
+}
+
+void GenerationEngine::mergeNew(rankKey *& order, int & size, double (*keyOf)(const Individual &), int prefixCount, int topCount, const bool * keep) {
+    Individual *pool = buffers[current];
+
+    // A new individual can only be in the best topCount if it comes before the last of the best topCount already in order
+    // New individuals have higher indexes, so one with an equal key comes after it
+    bool limited = size >= topCount && topCount > 0;
+    rankKey last = {};
+    if (limited) {
+        last = order[topCount - 1];
+    }
+
+    int candidates = 0;
+    for (int i = prefixCount; i < poolSize; i++) {
+        rankKey entry;
+        entry.key = keyOf(pool[i]);
+        entry.index = i;
+        if (!limited || entry < last) {
+            newKeys[candidates] = entry;
+            candidates++;
+        }
+    }
+
+    // Of those, only the best topCount can be needed
+    int count = candidates;
+    if (topCount < candidates) {
+        std::nth_element(newKeys, newKeys + topCount, newKeys + candidates);
+        count = topCount;
+        // Keep the ones that were left out if they are wanted anyway
+        if (keep != nullptr) {
+            for (int i = topCount; i < candidates; i++) {
+                if (keep[newKeys[i].index]) {
+                    newKeys[count] = newKeys[i];
+                    count++;
+                }
+            }
+        }
+    }
+    // Wanted new individuals that were not candidates at all
+    if (keep != nullptr && limited) {
+        for (int i = prefixCount; i < poolSize; i++) {
+            rankKey entry;
+            entry.key = keyOf(pool[i]);
+            entry.index = i;
+            if (keep[i] && !(entry < last)) {
+                newKeys[count] = entry;
+                count++;
+            }
+        }
+    }
+
+    std::sort(newKeys, newKeys + count);
+    std::merge(order, order + size, newKeys, newKeys + count, mergeKeys);
+    std::swap(order, mergeKeys);
+    size += count;
+}
+
+void GenerationEngine::rankGeneration(int newInd) {
+    // The orderings can only be reused if the individuals before the new ones are the ones they were made for
+    int prefixCount = poolSize - newInd;
+    if (prefixCount != rankedCount) {
+        prefixCount = 0;
+        costSize = posSize = velSize = 0;
+    }
+
+    // Cost only needs the individuals sortByCost() puts in order
+    mergeNew(costOrder, costSize, costKey, prefixCount, sortCount, nullptr);
+
+    // New individuals that will be kept need to be in the posDiff and velDiff orderings for the next generation
+    for (int i = prefixCount; i < poolSize; i++) {
+        keptNew[i] = false;
+    }
+    for (int i = 0; i < keptCount; i++) {
+        if (costOrder[i].index >= prefixCount) {
+            keptNew[costOrder[i].index] = true;
+        }
+    }
+    // Anything in the best survivor_count could be selected
+    mergeNew(posOrder, posSize, posDiffKey, prefixCount, survivorSize, keptNew);
+    mergeNew(velOrder, velSize, velDiffKey, prefixCount, survivorSize, keptNew);
+    rankedCount = poolSize;
+
+    // Children of the next generation that cannot beat the last survivors chosen now are pruned, kept individuals stay
+    // in the orderings so the boundaries only tighten, prune_margin allows for the velDiff boundary loosening when they are not kept
+    if (prune.checkpoints > 0) {
+        int posCount = static_cast<int>(survivorSize * cConstants->survivorRatio);
+        if (posCount > survivorSize) {
+            posCount = survivorSize;
+        }
+        if (posCount == 0) {
+            prune.posCutoff = -INFINITY;
+        }
+        else {
+            prune.posCutoff = (posCount <= posSize) ? posOrder[posCount - 1].key : INFINITY;
+        }
+        // A pruned individual's cost is only a lower bound, so it must also be one that would not be kept or sorted
+        // (cost is posDiff), or it would take the place of one that is and change the later generations
+        if (sortCount > 0) {
+            prune.posCutoff = fmax(prune.posCutoff, (sortCount <= costSize) ? costOrder[sortCount - 1].key : INFINITY);
+        }
+        prune.posCutoff *= cConstants->prune_margin;
+        if (posCount == survivorSize) {
+            prune.velCutoff = INFINITY;
+        }
+        else {
+            prune.velCutoff = (survivorSize <= velSize) ? -velOrder[survivorSize - 1].key / cConstants->prune_margin : -INFINITY;
+        }
+        pruneReady = true;
+    }
+}
+
+int GenerationEngine::remapOrder(rankKey * order, int size) {
+    int count = 0;
+    for (int i = 0; i < size; i++) {
+        int moved = newIndex[order[i].index];
+        if (moved >= 0) {
+            order[count].key = order[i].key;
+            order[count].index = moved;
+            count++;
+        }
+    }
+
+    // Individuals with equal keys may now be out of index order, put them back so merging gives the same order as a full sort
+    // Only equal keys move, so this is a single pass when there are none
+    for (int i = 1; i < count; i++) {
+        rankKey moving = order[i];
+        int j = i - 1;
+        while (j >= 0 && moving < order[j]) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = moving;
+    }
+    return count;
+}
+
+void GenerationEngine::sortByCost() {
+    Individual *pool = buffers[current];
+    Individual *next = buffers[1 - current];
+
+    for (int i = 0; i < sortCount; i++) {
+        next[i] = pool[costOrder[i].index];
+    }
+    current = 1 - current;
+
+    // Carry the orderings over to the kept individuals in their new places
+    for (int i = 0; i < poolSize; i++) {
+        newIndex[i] = -1;
+    }
+    for (int i = 0; i < keptCount; i++) {
+        newIndex[costOrder[i].index] = i;
+    }
+    costSize = remapOrder(costOrder, costSize);
+    posSize = remapOrder(posOrder, posSize);
+    velSize = remapOrder(velOrder, velSize);
+    rankedCount = keptCount;
+}
+
+int GenerationEngine::nextGeneration(double annealing, double generation) {
+    // The best individuals carry over unchanged, the end of the buffer is replaced by children
+    return newGeneration(survivors, buffers[current], survivorSize, poolSize, annealing, cConstants, generation, arenas);
+}
+
+GenerationEngine::~GenerationEngine() {
+    delete [] buffers[0];
+    delete [] buffers[1];
+    delete [] survivors;
+    delete [] costOrder;
+    delete [] posOrder;
+    delete [] velOrder;
+    delete [] newKeys;
+    delete [] mergeKeys;
+    delete [] keptNew;
+    delete [] newIndex;
+    delete cache;
+    delete screen;
+    delete [] arenas;
+}
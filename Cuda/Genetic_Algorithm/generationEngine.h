@@ -0,0 +1,148 @@
+#ifndef GENERATIONENGINE_H
+#define GENERATIONENGINE_H
+
+#include "ga_crossover.h"                 // for newGeneration() and rankKey
+#include "fitnessCache.h"                 // for FitnessCache, skips evaluating repeated genomes
+#include "fitnessScreen.h"                // for FitnessScreen, the coarse pass over new individuals
+#include "../Runge_Kutta/pruning.h"       // for pruneBounds, the survivor cutoffs trajectories are pruned against
+#include "../Host_Threads/scratchArena.h" // for ScratchArena, each thread's scratch memory
+#include "../Host_Threads/threadPool.h"   // for cpuPool, sets how many arenas are needed
+
+// Owns all of the memory the genetic algorithm uses from one generation to the next, so after the first generations
+// (while the scratch arenas grow to size) making and evaluating a generation does no heap allocations
+//     - two population buffers of num_individuals, the current generation is in one and sortByCost() gathers it into the other
+//     - the survivors array
+//     - the generation's cost, posDiff, and velDiff orderings, carried from one generation to the next
+//     - the FitnessCache of evaluated genomes, when fitness_cache_size is set
+//     - the FitnessScreen's lists, when screen_max_numsteps is set
+//     - a ScratchArena for each thread of cpuPool, used by newGeneration() and callRKCPU()
+// Used by optimize() in optimization.cu, one engine for each run
+class GenerationEngine {
+    private:
+        Individual *buffers[2]; // population buffers, each of poolSize individuals
+        int current;            // index in buffers of the current generation
+
+        Individual *survivors;  // survivorSize individuals, filled by selectSurvivors()
+
+        // (key, index) of individuals in the current generation in order of cost, posDiff, and -velDiff
+        // Between sortByCost() and the next rankGeneration() they hold all of the rankedCount kept individuals,
+        // after rankGeneration() they hold the kept individuals merged with the new individuals that can be used:
+        // those in the best of each ordering (sortByCost()'s count for cost, survivor_count for the others) and, in the posDiff
+        // and velDiff orderings, those that sortByCost() will keep
+        rankKey *costOrder;
+        rankKey *posOrder;
+        rankKey *velOrder;
+        int costSize, posSize, velSize; // number of keys in each ordering
+        int rankedCount; // number of individuals at the front of population() that the orderings were carried over for
+
+        rankKey *newKeys;   // keys of the new individuals being sorted by rankGeneration()
+        rankKey *mergeKeys; // merged ordering, swapped with the ordering it replaces
+        bool *keptNew;      // true for the new individuals that will be kept, so they are in every ordering
+        int *newIndex;      // where sortByCost() moved each individual, -1 if it is not kept
+
+        FitnessCache *cache; // nullptr if fitness_cache_size is 0
+        int lookupCount;     // new individuals given to the last findCached()
+
+        FitnessScreen *screen; // nullptr if screen_max_numsteps is 0
+
+        pruneBounds prune; // survivor cutoffs of the last rankGeneration(), used when prune_checkpoints is set
+        bool pruneReady;   // false until rankGeneration() has found the cutoffs
+
+        ScratchArena *arenas;   // one for each thread of cpuPool, or one if there is no pool
+        int arenaCount;
+
+        int poolSize;     // num_individuals
+        int survivorSize; // survivor_count
+        int keptCount;    // individuals kept each generation, the rest are replaced by children
+        int sortCount;    // individuals sortByCost() puts in order, keptCount or best_count if that is more
+
+        const cudaConstants *cConstants;
+
+        // Sorts the keys of the new individuals (those from prefixCount on) that are needed and merges them into order
+        // Input: order, size - ordering of the individuals before prefixCount
+        //        keyOf - gets the key of an individual for this ordering
+        //        topCount - the new individuals that could be in the best topCount of the merged ordering are included,
+        //                   found with nth_element so only those are sorted
+        //        keep - new individuals with keep[index] true are also included, nullptr for none
+        // Output: order points to the merged ordering (its old array becomes mergeKeys), size is its length
+        void mergeNew(rankKey *& order, int & size, double (*keyOf)(const Individual &), int prefixCount, int topCount, const bool * keep);
+
+        // Drops the individuals sortByCost() did not keep from order and changes the indexes to where they were moved to
+        // Input: order, size - ordering made by rankGeneration()
+        // Output: order holds the kept individuals that were in it, still in order, returns how many that is
+        int remapOrder(rankKey * order, int size);
+
+    public:
+        // Allocates the buffers and arenas
+        // Input: cConstants - num_individuals and survivor_count set the sizes, kept for nextGeneration()
+        GenerationEngine(const cudaConstants* cConstants);
+
+        // The current generation, num_individuals long
+        // The pointer changes every sortByCost(), so it should not be kept across generations
+        Individual * population();
+
+        // Array of survivor_count individuals for selectSurvivors() to fill
+        Individual * getSurvivors();
+
+        // Orderings of the current generation made by rankGeneration(), for selectSurvivors()
+        const rankKey * getPosOrder();
+        const rankKey * getVelOrder();
+
+        // Scratch memory for each thread of cpuPool, passed to callRKCPU()
+        ScratchArena * getArenas();
+
+        // Total size of the scratch arenas in bytes, stops changing once they have grown to what a generation needs
+        size_t scratchBytes();
+
+        // Finds the new individuals that repeat an already evaluated genome, when there is a fitness cache
+        // Input: newInd - number of new individuals at the end of population()
+        //        generation - current generation, for the cache's replacement order
+        // Output: new individuals found in the cache have their results, returns how many are left to evaluate at getToEvaluate()
+        //         without a cache all newInd are left to evaluate, in place
+        int findCached(int newInd, double generation);
+
+        // The individuals to evaluate after findCached(), a list owned by the cache or the end of population()
+        Individual * getToEvaluate();
+
+        // Once getToEvaluate() has been evaluated, stores the results in the cache and copies them to the new individuals
+        // Results the FitnessScreen left at its coarse pass are copied but not stored
+        void storeEvaluated();
+
+        // The fitness cache, nullptr if there is none
+        FitnessCache * getCache();
+
+        // The fitness screen, nullptr if there is none
+        FitnessScreen * getScreen();
+
+        // Cutoffs to prune the next new individuals against, from the survivor boundaries of the last rankGeneration()
+        // nullptr if prune_checkpoints is 0 or no generation has been ranked yet
+        const pruneBounds * getPruneBounds();
+
+        // Orders the current generation by cost, posDiff, and velDiff once the new individuals have been evaluated
+        // Input: newInd - number of new individuals at the end of population(), the rest must be the individuals kept by sortByCost()
+        // Output: only the new individuals' keys are sorted (the ones that can be used, see costOrder), then merged into the kept individuals' orderings
+        //         getPosOrder() and getVelOrder() have at least the best survivor_count of the generation in order
+        //         if the individuals before the new ones are not the ones that were kept (as in the first generation) they are all treated as new
+        //         the pruning cutoffs are set from the posDiff and velDiff of the last survivors selectSurvivors() will choose
+        void rankGeneration(int newInd);
+
+        // Sorts the current generation by cost (using Individual's operator<), as far as it is used
+        // Gathers the best individuals in rankGeneration()'s cost order into the other buffer, which becomes the current generation
+        // Output: the individuals kept by nextGeneration() (and at least best_count) are at the front of population() in order of cost,
+        //         the rest of population() is left over from an earlier generation and is only there to be replaced by nextGeneration()
+        //         the orderings are carried over to the kept individuals for the next rankGeneration()
+        void sortByCost();
+
+        // Makes the next generation in place, replacing the end of the current generation with children
+        // Input: annealing, generation - passed to newGeneration()
+        //        the current generation must have been sorted by sortByCost() and getSurvivors() filled by selectSurvivors()
+        // Output: newGeneration() fills the end of population() with children of the survivors
+        //         Returns the number of new individuals, which are at the end of population()
+        int nextGeneration(double annealing, double generation);
+
+        // Frees the buffers and arenas
+        ~GenerationEngine();
+};
+
+#include "generationEngine.cpp"
+#endif
@@ -5,16 +5,22 @@
 Individual::Individual() {
     this->posDiff = 1.0;
     this->velDiff = 0.0;
+    this->prunedTime = 0;
 }
 
 // Set the initial position of the spacecraft according to the newly generated parameters
 // Input: cConstants - to access c3energy value used in getCost()
 //        newInd - struct returned by generateNewIndividual()
 // Output: this individual's startParams.y0 is set to the initial position and velocity of the spacecraft
-Individual::Individual(rkParameters<double> & newInd, const cudaConstants* cConstants) {
+Individual::Individual(rkParameters<double> & newInd, const cudaConstants* cConstants) : Individual(newInd, launchCon->getCondition(newInd.tripTime), cConstants) {
+    // Earth's position and velocity at launch is found from launchCon
+}
+
+// Set the initial position of the spacecraft from the newly generated parameters and Earth's conditions at launch
+Individual::Individual(rkParameters<double> & newInd, const elements<double> & earth, const cudaConstants* cConstants) {
 
     this->startParams = newInd;
-    elements<double> earth = launchCon->getCondition(this->startParams.tripTime); //get Earth's position and velocity at launch
+    this->prunedTime = 0;
 
     this->startParams.y0 = elements<double>( // calculate the starting position and velocity of the spacecraft from Earth's position and velocity and spacecraft launch angles
         earth.r+ESOI*cos(this->startParams.alpha),
@@ -25,6 +31,36 @@ Individual::Individual(rkParameters<double> & newInd, const cudaConstants* cCons
         earth.vz+sin(this->startParams.zeta)*cConstants->v_escape);
 }
 
+// Sets up a group of individuals with startParams assigned, with one batched lookup of Earth's conditions
+void initStartPositions(Individual *individuals, const int & count, const cudaConstants* cConstants, ScratchArena *arena) {
+    double *tripTimes;
+    elements<double> *earth;
+    if (arena != nullptr) {
+        tripTimes = arena->take<double>(count);
+        earth = arena->take<elements<double>>(count);
+    }
+    else {
+        tripTimes = new double[count];
+        earth = new elements<double>[count];
+    }
+
+    for (int i = 0; i < count; i++) {
+        tripTimes[i] = individuals[i].startParams.tripTime;
+    }
+
+    // Trip times outside of the table are clamped to its ends, as with a single lookup
+    launchCon->getConditions(tripTimes, earth, count);
+
+    for (int i = 0; i < count; i++) {
+        individuals[i] = Individual(individuals[i].startParams, earth[i], cConstants);
+    }
+
+    if (arena == nullptr) {
+        delete [] tripTimes;
+        delete [] earth;
+    }
+}
+
 // Calculates a posDiff value
 // Input: cConstants in accessing properties such as r_fin_ast, theta_fin_ast, and z_fin_ast
 // Output: Assigns and returns this individual's posDiff value
@@ -3,6 +3,7 @@
 
 #include "../Runge_Kutta/rkParameters.h"
 #include "../Earth_calculations/earthInfo.h"
+#include "../Host_Threads/scratchArena.h" // for ScratchArena, scratch memory used by initStartPositions()
 
 // Individual is a structure member of the genetic algorithm's population and has set of parameters and the resulting position and velocity
 struct Individual {
@@ -13,6 +14,7 @@ struct Individual {
     double posDiff; // difference in position between spacecraft and center of asteroid at end of run
     double velDiff; // difference in velocity between spacecraft and asteroid at end of run
     double cost;    // cost value of the individual, something that the genetic algorithm is attempting to minimize
+    double prunedTime; // trip time left (s) when pruneTrajectory() stopped the integration, posDiff is then only a lower bound, 0 if it ran to the end
 
     // Default constructor
     Individual();
@@ -23,6 +25,9 @@ struct Individual {
     // Output: this individual's startParams.y0 is set to the initial position and velocity of the spacecraft
     Individual(rkParameters<double> & newInd, const cudaConstants* cConstants);
 
+    // Same as above, with Earth's position and velocity at launch already found (such as by launchCon->getConditions() for a group of individuals)
+    Individual(rkParameters<double> & newInd, const elements<double> & earth, const cudaConstants* cConstants);
+
     // Calculates a posDiff value
     // Input: cConstants in accessing properties such as r_fin_ast, theta_fin_ast, and z_fin_ast
     // Output: Assigns and returns this individual's posDiff value
@@ -54,6 +59,15 @@ bool BetterPosDiff(Individual& personA, Individual& personB);
 // output: returns true if personB has a higher velocity difference than personA
 bool BetterVelDiff(Individual& personA, Individual& personB);
 
+// Sets up a group of individuals that have had their startParams assigned, looking up Earth's conditions for all of their trip times
+// at once with launchCon->getConditions() rather than one at a time
+// Input: individuals - count individuals with startParams set (y0 is not needed)
+//        cConstants - passed to the Individual constructor
+//        arena - the calling thread's scratch memory for the lookup arrays, nullptr to allocate them here
+// Output: each individual is reset as by the Individual constructor, so startParams.y0 is the spacecraft's starting position and velocity
+// Called by newGeneration() in ga_crossover.cpp
+void initStartPositions(Individual *individuals, const int & count, const cudaConstants* cConstants, ScratchArena *arena = nullptr);
+
 //Utility to calculate the position difference between a position velocity set and the asteroid final position
 // Input: currentState - set of position and velocity coordinates
 //                       Often the final position/velocity of the spacecraft at the end of a RK run
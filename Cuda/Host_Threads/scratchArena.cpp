@@ -0,0 +1,59 @@
+ScratchArena::ScratchArena() {
+    block = nullptr;
+    capacity = 0;
+    used = 0;
+    overflow = nullptr;
+    overflowBytes = 0;
+}
+
+template <class T> T * ScratchArena::take(const size_t & count) {
+    // Round up so the next piece taken stays aligned
+    size_t bytes = (count * sizeof(T) + SCRATCH_ALIGN - 1) / SCRATCH_ALIGN * SCRATCH_ALIGN;
+
+    if (used + bytes <= capacity) {
+        char *piece = block + used;
+        used += bytes;
+        return reinterpret_cast<T*>(piece);
+    }
+
+    // Not enough room left, make an overflow block with the header padded to keep the data aligned
+    const size_t headerBytes = (sizeof(overflowBlock) + SCRATCH_ALIGN - 1) / SCRATCH_ALIGN * SCRATCH_ALIGN;
+    overflowBlock *extra = reinterpret_cast<overflowBlock*>(new char[headerBytes + bytes]);
+    extra->next = overflow;
+    overflow = extra;
+    overflowBytes += bytes;
+
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(extra) + headerBytes);
+}
+
+void ScratchArena::reset() {
+    if (overflow != nullptr) {
+        // Grow the block to hold everything taken since the last reset
+        size_t needed = used + overflowBytes;
+
+        while (overflow != nullptr) {
+            overflowBlock *next = overflow->next;
+            delete [] reinterpret_cast<char*>(overflow);
+            overflow = next;
+        }
+        overflowBytes = 0;
+
+        delete [] block;
+        block = new char[needed];
+        capacity = needed;
+    }
+    used = 0;
+}
+
+size_t ScratchArena::size() {
+    return capacity;
+}
+
+ScratchArena::~ScratchArena() {
+    while (overflow != nullptr) {
+        overflowBlock *next = overflow->next;
+        delete [] reinterpret_cast<char*>(overflow);
+        overflow = next;
+    }
+    delete [] block;
+}
@@ -0,0 +1,49 @@
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+
+#include <cstddef> // for size_t
+
+// Alignment of everything handed out by ScratchArena::take(), enough for any type used on the host
+#define SCRATCH_ALIGN 16
+
+// Block of scratch memory owned by one thread, handed out in pieces by take() and given back all at once by reset()
+// Work repeated every generation (Earth lookups, thrust tables) takes its temporary arrays from here instead of new/delete,
+// once the block has grown to the most that is taken between resets no more heap allocations are made
+// Only for plain data, no constructors or destructors are run on what is taken
+class ScratchArena {
+    private:
+        // Extra block made when take() asks for more than is left in block, the data follows this header
+        struct overflowBlock {
+            overflowBlock *next;
+        };
+
+        char *block;     // memory handed out by take()
+        size_t capacity; // size of block in bytes
+        size_t used;     // bytes of block handed out since the last reset()
+
+        overflowBlock *overflow; // overflow blocks made since the last reset(), most recent first
+        size_t overflowBytes;    // bytes handed out from the overflow blocks since the last reset()
+
+    public:
+        // Constructor, starts with an empty block that grows on the first reset() after it is used
+        ScratchArena();
+
+        // Takes count uninitialized values of type T, valid until the next reset()
+        // Input: count - number of values
+        // Output: pointer aligned to SCRATCH_ALIGN, from the block if there is room or a new overflow block if not
+        template <class T> T * take(const size_t & count);
+
+        // Gives back everything taken, which must no longer be in use
+        // If overflow blocks were needed the block is replaced with one that fits everything taken since the last reset,
+        // so the same work afterwards fits without allocating
+        void reset();
+
+        // Size of the block in bytes
+        size_t size();
+
+        // Frees the block and any overflow blocks
+        ~ScratchArena();
+};
+
+#include "scratchArena.cpp"
+#endif
@@ -0,0 +1,92 @@
+// Constructor, starts numThreads-1 worker threads that wait for a job from run()
+ThreadPool::ThreadPool(int numThreads) {
+    // If no thread count is given, use one thread per available core
+    if (numThreads <= 0) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    // hardware_concurrency() may return 0 if it is unable to tell
+    if (numThreads <= 0) {
+        numThreads = 1;
+    }
+    threadCount = numThreads;
+
+    task = nullptr;
+    context = nullptr;
+    jobId = 0;
+    remaining = 0;
+    stopping = false;
+
+    // The calling thread is thread 0, so only threadCount-1 threads need to be created
+    workers = new std::thread[threadCount - 1];
+    for (int i = 1; i < threadCount; i++) {
+        workers[i - 1] = std::thread(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+void ThreadPool::workerLoop(int threadId) {
+    unsigned int lastJob = 0;
+
+    while (true) {
+        void (*curTask)(int, int, void*);
+        void *curContext;
+
+        // Wait until there is a new job (or the pool is being destroyed)
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            startJob.wait(guard, [&] { return stopping || jobId != lastJob; });
+            if (stopping) {
+                return;
+            }
+            lastJob = jobId;
+            curTask = task;
+            curContext = context;
+        }
+
+        curTask(threadId, threadCount, curContext);
+
+        // Report this thread is done, the last one to finish wakes up run()
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            remaining--;
+            if (remaining == 0) {
+                jobDone.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::run(void (*newTask)(int threadId, int numThreads, void* context), void* newContext) {
+    // Hand the job to the worker threads
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        task = newTask;
+        context = newContext;
+        remaining = threadCount - 1;
+        jobId++;
+    }
+    startJob.notify_all();
+
+    // The calling thread does its share as thread 0
+    newTask(0, threadCount, newContext);
+
+    // Wait for the worker threads to finish their share
+    std::unique_lock<std::mutex> guard(lock);
+    jobDone.wait(guard, [&] { return remaining == 0; });
+}
+
+int ThreadPool::size() {
+    return threadCount;
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        stopping = true;
+    }
+    startJob.notify_all();
+
+    for (int i = 0; i < threadCount - 1; i++) {
+        workers[i].join();
+    }
+    delete [] workers;
+}
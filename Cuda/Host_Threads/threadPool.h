@@ -0,0 +1,60 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <thread>             // std::thread for the worker threads
+#include <mutex>              // std::mutex, std::unique_lock
+#include <condition_variable> // used to wake workers and to wait for a job to finish
+
+// Persistent pool of CPU worker threads used by the host (non-GPU) parts of the program
+// Threads are created once and sleep between jobs, so dispatching a job does not create or destroy threads
+// The thread that calls run() takes part in the job as thread 0, so a pool of size 1 runs everything on the calling thread
+class ThreadPool {
+    private:
+        // Worker threads, length threadCount-1 (the calling thread is the remaining one)
+        std::thread *workers;
+        // Total number of threads working on a job, including the calling thread
+        int threadCount;
+
+        // Current job, set by run() and read by the workers
+        void (*task)(int threadId, int numThreads, void* context);
+        void *context;
+
+        // Incremented by run() for every new job, workers compare it to the last job they did to know when to start
+        unsigned int jobId;
+        // Number of worker threads that have not finished the current job
+        int remaining;
+        // Set by the destructor to have the workers exit their loop
+        bool stopping;
+
+        std::mutex lock;
+        std::condition_variable startJob;
+        std::condition_variable jobDone;
+
+        // Loop each worker thread runs until the pool is destroyed
+        // Input: threadId - this worker's index in the pool (1 to threadCount-1)
+        void workerLoop(int threadId);
+
+    public:
+        // Constructor, starts the worker threads
+        // Input: numThreads - total threads to use, if 0 or less uses std::thread::hardware_concurrency()
+        ThreadPool(int numThreads);
+
+        // Runs task on every thread in the pool and returns once all threads have finished
+        // Input: task - function called once per thread with that thread's index (0 to numThreads-1), the total number of threads, and context
+        //        context - pointer passed through to task, holds whatever the job needs
+        // Output: task has been completed by every thread
+        void run(void (*task)(int threadId, int numThreads, void* context), void* context);
+
+        // Returns the number of threads used by run(), including the calling thread
+        int size();
+
+        // Stops and joins the worker threads
+        ~ThreadPool();
+};
+
+#include "threadPool.cpp"
+
+// Global pool for host side parallel work (assigned in optimization.cu)
+ThreadPool *cpuPool = nullptr;
+
+#endif
@@ -0,0 +1,129 @@
+WorkStealingScheduler::WorkStealingScheduler(int numThreads) {
+    threadCount = numThreads;
+    queues = new chunkQueue[threadCount];
+    stats = new threadLoadStats[threadCount];
+    reset(0, 1);
+}
+
+void WorkStealingScheduler::reset(int items, int itemsPerChunk) {
+    numItems = items;
+    chunkSize = (itemsPerChunk < 1) ? 1 : itemsPerChunk;
+
+    int numChunks = (numItems + chunkSize - 1) / chunkSize;
+
+    // Deal the chunks out in contiguous ranges as evenly as possible
+    for (int i = 0; i < threadCount; i++) {
+        queues[i].head = (numChunks * i) / threadCount;
+        queues[i].tail = (numChunks * (i + 1)) / threadCount;
+
+        stats[i].items = 0;
+        stats[i].chunks = 0;
+        stats[i].steals = 0;
+        stats[i].busyTime = 0;
+        stats[i].tableFallbacks = 0;
+    }
+}
+
+bool WorkStealingScheduler::nextChunk(int threadId, int & begin, int & end) {
+    chunkQueue & own = queues[threadId];
+    int chunk = -1;
+
+    // Take from the front of this thread's own queue
+    own.lock.lock();
+    if (own.head < own.tail) {
+        chunk = own.head;
+        own.head++;
+    }
+    own.lock.unlock();
+
+    // Own queue is empty, look through the other threads for work to steal
+    // Starts at the next thread so threads that run out at the same time look at different victims first
+    for (int offset = 1; chunk == -1 && offset < threadCount; offset++) {
+        chunkQueue & victim = queues[(threadId + offset) % threadCount];
+
+        victim.lock.lock();
+        int available = victim.tail - victim.head;
+        if (available > 0) {
+            // Take the back half (rounded up) of what is left, keeping the first of those chunks to process now
+            int stolen = (available + 1) / 2;
+            victim.tail -= stolen;
+            chunk = victim.tail;
+            victim.lock.unlock();
+
+            // The rest of the stolen chunks go into this thread's own (empty) queue where other threads can steal them back
+            own.lock.lock();
+            own.head = chunk + 1;
+            own.tail = chunk + stolen;
+            own.lock.unlock();
+
+            stats[threadId].steals++;
+        }
+        else {
+            victim.lock.unlock();
+        }
+    }
+
+    if (chunk == -1) {
+        // No work left anywhere
+        return false;
+    }
+
+    begin = chunk * chunkSize;
+    end = begin + chunkSize;
+    if (end > numItems) {
+        end = numItems;
+    }
+
+    stats[threadId].items += end - begin;
+    stats[threadId].chunks++;
+    return true;
+}
+
+void WorkStealingScheduler::addBusyTime(int threadId, double seconds) {
+    stats[threadId].busyTime += seconds;
+}
+
+void WorkStealingScheduler::addTableFallbacks(int threadId, int count) {
+    stats[threadId].tableFallbacks += count;
+}
+
+loadBalanceSummary WorkStealingScheduler::getSummary() {
+    loadBalanceSummary summary;
+    summary.threads = threadCount;
+    summary.items = 0;
+    summary.chunks = 0;
+    summary.steals = 0;
+    summary.minBusyTime = stats[0].busyTime;
+    summary.maxBusyTime = stats[0].busyTime;
+    summary.meanBusyTime = 0;
+    summary.tableFallbacks = 0;
+
+    for (int i = 0; i < threadCount; i++) {
+        summary.items += stats[i].items;
+        summary.chunks += stats[i].chunks;
+        summary.steals += stats[i].steals;
+        summary.meanBusyTime += stats[i].busyTime;
+        summary.tableFallbacks += stats[i].tableFallbacks;
+        if (stats[i].busyTime < summary.minBusyTime) {
+            summary.minBusyTime = stats[i].busyTime;
+        }
+        if (stats[i].busyTime > summary.maxBusyTime) {
+            summary.maxBusyTime = stats[i].busyTime;
+        }
+    }
+    summary.meanBusyTime /= threadCount;
+
+    // If nothing was timed (empty job), consider it balanced
+    if (summary.meanBusyTime > 0) {
+        summary.imbalance = summary.maxBusyTime / summary.meanBusyTime;
+    }
+    else {
+        summary.imbalance = 1;
+    }
+    return summary;
+}
+
+WorkStealingScheduler::~WorkStealingScheduler() {
+    delete [] queues;
+    delete [] stats;
+}
@@ -0,0 +1,79 @@
+#ifndef WORKSTEALING_H
+#define WORKSTEALING_H
+
+#include <mutex> // std::mutex for each thread's queue
+
+// Range of chunk indexes that one thread currently owns
+// The owning thread takes chunks from the front (head), other threads steal from the back (tail)
+struct chunkQueue {
+    std::mutex lock;
+    int head; // next chunk the owner will take
+    int tail; // one past the last chunk in this queue
+};
+
+// Load balance information for one thread over the last job
+struct threadLoadStats {
+    int items;       // number of items (individuals) this thread processed
+    int chunks;      // number of chunks this thread processed
+    int steals;      // number of times this thread stole chunks from another thread
+    double busyTime; // seconds spent processing chunks
+    int tableFallbacks; // items whose thrust table could not meet thrust_table_tol, so they used the Fourier series
+};
+
+// Summary of the load balance of the last job, from WorkStealingScheduler::getSummary()
+struct loadBalanceSummary {
+    int threads;        // threads that took part
+    int items;          // total items processed
+    int chunks;         // total chunks processed
+    int steals;         // total successful steals
+    double minBusyTime; // least time a thread spent working (s)
+    double maxBusyTime; // most time a thread spent working (s), effectively the time the job took
+    double meanBusyTime;
+    double imbalance;   // maxBusyTime / meanBusyTime, 1 is perfectly balanced
+    int tableFallbacks; // total items whose thrust table could not meet thrust_table_tol
+};
+
+// Schedules chunks of a job over the threads of a ThreadPool using work stealing
+// Each thread starts with an equal contiguous range of chunks, and when it runs out it steals half of what remains from another thread
+// This keeps all threads busy when some items take much longer than others (such as individuals with more runge kutta steps)
+// Memory is allocated once in the constructor so a job does not allocate
+class WorkStealingScheduler {
+    private:
+        chunkQueue *queues;     // one queue per thread
+        threadLoadStats *stats; // one set of stats per thread
+        int threadCount;
+
+        int numItems;  // total items in the current job
+        int chunkSize; // items per chunk, the last chunk may be smaller
+
+    public:
+        // Constructor, allocates a queue and stats for each thread
+        // Input: numThreads - number of threads that will call nextChunk(), normally the size of the ThreadPool
+        WorkStealingScheduler(int numThreads);
+
+        // Sets up a new job, must be called before the threads start calling nextChunk()
+        // Input: items - number of items to process, numbered 0 to items-1
+        //        itemsPerChunk - how many items are handed out at a time, values less than 1 are set to 1
+        // Output: each thread's queue holds an equal contiguous share of the chunks and the stats are cleared
+        void reset(int items, int itemsPerChunk);
+
+        // Gets the next range of items for a thread to process, stealing from other threads when its own queue is empty
+        // Input: threadId - index of the calling thread (0 to numThreads-1)
+        // Output: returns false when there is no work left in any queue
+        //         otherwise returns true and items begin to end-1 are to be processed by this thread
+        bool nextChunk(int threadId, int & begin, int & end);
+
+        // Adds to the time a thread spent processing chunks, called by each thread when it runs out of work
+        void addBusyTime(int threadId, double seconds);
+
+        // Adds to the items of a thread whose thrust table could not meet thrust_table_tol, called by each thread when it runs out of work
+        void addTableFallbacks(int threadId, int count);
+
+        // Returns the load balance summary of the last job
+        loadBalanceSummary getSummary();
+
+        ~WorkStealingScheduler();
+};
+
+#include "workStealing.cpp"
+#endif
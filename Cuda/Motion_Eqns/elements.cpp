@@ -53,6 +53,10 @@ template <class T> elements<T> elements<T>::operator/(const T & i) const {
     return elements<T>( this->r / i, this->theta / i, this->z / i, this->vr / i, this->vtheta / i, this->vz / i);
 }
 
+template <class T> bool elements<T>::operator==(const elements<T> & e) const {
+    return this->r == e.r && this->theta == e.theta && this->z == e.z && this->vr == e.vr && this->vtheta == e.vtheta && this->vz == e.vz;
+}
+
 // Comparison method to compare this elements to another, returning true (equivalent) within a threshold
 // input: other - another elements object to compare to
 //        comp_Thresh - a threshold for comparison, so when elements are considered equivalent it is a not necessarrily 100% (when not equal to 0)
@@ -36,6 +36,9 @@ template <class T> struct elements {
     __host__ __device__ elements<T> operator*(const T& i) const;
     __host__ __device__ elements<T> operator/(const T& i) const;
 
+    // Exact comparison of every component, true only if all are equal
+    __host__ __device__ bool operator==(const elements<T>& e) const;
+
 
     // Comparison method to compare this elements to another, returning true (equivalent) within a threshold
     // input: other - another elements object to compare to
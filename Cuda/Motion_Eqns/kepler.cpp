@@ -0,0 +1,100 @@
+#include <math.h> // sqrt, sin, cos, sinh, cosh, atan2, floor
+
+template <class T> __host__ __device__ cartesianState<T> cylindricalToCartesian(const elements<T> & y) {
+    T cosTheta = cos(y.theta);
+    T sinTheta = sin(y.theta);
+
+    cartesianState<T> s;
+    s.pos[0] = y.r*cosTheta;
+    s.pos[1] = y.r*sinTheta;
+    s.pos[2] = y.z;
+    s.vel[0] = y.vr*cosTheta - y.vtheta*sinTheta;
+    s.vel[1] = y.vr*sinTheta + y.vtheta*cosTheta;
+    s.vel[2] = y.vz;
+    return s;
+}
+
+template <class T> __host__ __device__ elements<T> cartesianToCylindrical(const cartesianState<T> & s, const T & thetaRef) {
+    T r = sqrt(s.pos[0]*s.pos[0] + s.pos[1]*s.pos[1]);
+    T theta = atan2(s.pos[1], s.pos[0]);
+    // Move theta by whole turns to the angle nearest thetaRef
+    theta += 2*M_PI*floor((thetaRef - theta)/(2*M_PI) + 0.5);
+
+    T cosTheta = s.pos[0]/r;
+    T sinTheta = s.pos[1]/r;
+    return elements<T>(r, theta, s.pos[2],
+                       s.vel[0]*cosTheta + s.vel[1]*sinTheta, -s.vel[0]*sinTheta + s.vel[1]*cosTheta, s.vel[2]);
+}
+
+template <class T> __host__ __device__ void calc_stumpff(const T & psi, T & c2, T & c3) {
+    if (psi > 1) {
+        T sqrtPsi = sqrt(psi);
+        c2 = (1 - cos(sqrtPsi))/psi;
+        c3 = (sqrtPsi - sin(sqrtPsi))/(psi*sqrtPsi);
+    }
+    else if (psi < -1) {
+        T sqrtPsi = sqrt(-psi);
+        c2 = (1 - cosh(sqrtPsi))/psi;
+        c3 = (sinh(sqrtPsi) - sqrtPsi)/(-psi*sqrtPsi);
+    }
+    else {
+        // c2 = sum of (-psi)^k/(2k+2)! and c3 = sum of (-psi)^k/(2k+3)!, for |psi| <= 1 the terms after k = 10 are below double precision
+        T term2 = static_cast<T>(1)/2;
+        T term3 = static_cast<T>(1)/6;
+        c2 = term2;
+        c3 = term3;
+        for (int k = 1; k <= 10; k++) {
+            term2 *= -psi/((2*k+1)*(2*k+2));
+            term3 *= -psi/((2*k+2)*(2*k+3));
+            c2 += term2;
+            c3 += term3;
+        }
+    }
+}
+
+template <class T> __host__ __device__ cartesianState<T> keplerPropagate(const cartesianState<T> & s0, const T & dt, const T & mu) {
+    T sqrtMu = sqrt(mu);
+    T r0 = sqrt(s0.pos[0]*s0.pos[0] + s0.pos[1]*s0.pos[1] + s0.pos[2]*s0.pos[2]);
+    T v0Sq = s0.vel[0]*s0.vel[0] + s0.vel[1]*s0.vel[1] + s0.vel[2]*s0.vel[2];
+    T rDotV = (s0.pos[0]*s0.vel[0] + s0.pos[1]*s0.vel[1] + s0.pos[2]*s0.vel[2])/sqrtMu;
+    // Reciprocal of the semi-major axis, positive for ellipses
+    T alpha = 2/r0 - v0Sq/mu;
+
+    // First guess of the universal variable chi
+    T chi;
+    if (alpha > 1e-12) {
+        chi = sqrtMu*dt*alpha;
+    }
+    else {
+        chi = sqrtMu*dt/r0;
+    }
+
+    // Newton's method on the universal Kepler equation
+    T psi, c2, c3, r, delta;
+    for (int i = 0; i < 50; i++) {
+        psi = chi*chi*alpha;
+        calc_stumpff(psi, c2, c3);
+        r = chi*chi*c2 + rDotV*chi*(1 - psi*c3) + r0*(1 - psi*c2);
+        delta = (sqrtMu*dt - chi*chi*chi*c3 - rDotV*chi*chi*c2 - r0*chi*(1 - psi*c3))/r;
+        chi += delta;
+        if (fabs(delta) <= 1e-14*fabs(chi)) {
+            break;
+        }
+    }
+    psi = chi*chi*alpha;
+    calc_stumpff(psi, c2, c3);
+    r = chi*chi*c2 + rDotV*chi*(1 - psi*c3) + r0*(1 - psi*c2);
+
+    // Lagrange coefficients
+    T f = 1 - chi*chi*c2/r0;
+    T g = dt - chi*chi*chi*c3/sqrtMu;
+    T fDot = sqrtMu*chi*(psi*c3 - 1)/(r*r0);
+    T gDot = 1 - chi*chi*c2/r;
+
+    cartesianState<T> s;
+    for (int i = 0; i < 3; i++) {
+        s.pos[i] = f*s0.pos[i] + g*s0.vel[i];
+        s.vel[i] = fDot*s0.pos[i] + gDot*s0.vel[i];
+    }
+    return s;
+}
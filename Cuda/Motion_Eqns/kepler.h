@@ -0,0 +1,37 @@
+#ifndef KEPLER_H
+#define KEPLER_H
+
+#include "elements.h"
+
+// Closed form two body (sun only) motion, the same dynamics calc_kEarth() integrates
+// Used by EarthInfo when earth_mode=KEPLER to find earth's conditions without a table
+
+// Position and velocity in cartesian coordinates, sun centered with x along theta = 0
+template <class T> struct cartesianState {
+    T pos[3]; // x, y, z (AU)
+    T vel[3]; // vx, vy, vz (AU/s)
+};
+
+// Converts cylindrical elements to a cartesianState
+template <class T> __host__ __device__ cartesianState<T> cylindricalToCartesian(const elements<T> & y);
+
+// Converts a cartesianState to cylindrical elements
+// Input: s - state to convert
+//        thetaRef - estimate of the unwrapped angle, theta is returned as the angle equal to atan2(y, x) nearest to it
+//                   (angles along an integration keep growing past 2 pi, so this keeps the result continuous with them)
+// Output: elements of s in cylindrical coordinates
+template <class T> __host__ __device__ elements<T> cartesianToCylindrical(const cartesianState<T> & s, const T & thetaRef);
+
+// Stumpff functions c2(psi) = (1 - cos(sqrt(psi)))/psi and c3(psi) = (sqrt(psi) - sin(sqrt(psi)))/sqrt(psi)^3,
+// with their hyperbolic forms for negative psi and their series near 0 where the closed forms lose precision
+template <class T> __host__ __device__ void calc_stumpff(const T & psi, T & c2, T & c3);
+
+// Propagates a two body state by dt with the universal variable formulation of Kepler's equation,
+// solved by Newton's method, which works for any orbit type (Vallado, Fundamentals of Astrodynamics, algorithm 8)
+// Input: s0 - state at the start, dt - time to propagate (s, negative propagates backwards), mu - gravitational parameter (AU^3/s^2)
+// Output: returns the state dt after s0
+template <class T> __host__ __device__ cartesianState<T> keplerPropagate(const cartesianState<T> & s0, const T & dt, const T & mu);
+
+#include "kepler.cpp"
+
+#endif
@@ -5,10 +5,24 @@
 	
 #include <math.h> // used for sine, cosine, and pow functions
 
-template <class T>  __host__ __device__ elements<T> calc_k(const T & h, const elements<T>  & y, coefficients<T> & coeff, const T & accel, const T & curTime, const T & timeFinal) {
+template <class T, class P>  __host__ __device__ elements<T> calc_k(const T & h, const elements<T>  & y, P & profile, const T & accel, const T & curTime, const T & timeFinal) {
+	return calc_k(h, y, calc_stageAngles(profile, accel, curTime, timeFinal), accel);
+}
+
+template <class T>  __host__ __device__ elements<T> calc_k(const T & h, const elements<T>  & y, const thrustAngles<T> & angles, const T & accel) {
 	return elements<T>( h*calcRate_r(y), h*calcRate_theta(y), h*calcRate_z(y), 
-						h*calcRate_vr(y,coeff,accel,curTime, timeFinal), h*calcRate_vtheta(y,coeff,accel,curTime, timeFinal),
-						h*calcRate_vz(y,coeff,accel,curTime, timeFinal));
+						h*calcRate_vr(y,angles,accel), h*calcRate_vtheta(y,angles,accel),
+						h*calcRate_vz(y,angles,accel));
+}
+
+template <class T, class P>  __host__ __device__ thrustAngles<T> calc_stageAngles(P & profile, const T & accel, const T & curTime, const T & timeFinal) {
+	if (accel == 0) {
+		// Coasting, the direction is multiplied by 0 so the Fourier series are not needed
+		thrustAngles<T> angles;
+		angles.sinGamma = angles.cosGamma = angles.sinTau = angles.cosTau = 0;
+		return angles;
+	}
+	return calc_thrustAngles(profile, curTime, timeFinal);
 }
 
 template <class T> __host__ __device__ elements<T> calc_kEarth(const T & h, const elements<T>  & y, const T & curTime, const T & timeFinal) {
@@ -17,6 +31,18 @@ template <class T> __host__ __device__ elements<T> calc_kEarth(const T & h, cons
 						h*calcRate_vzEarth(y));
 }
 
+template <class T> __host__ __device__ elements<T> calc_gravityRate(const elements<T> & y, const T & mu) {
+	return elements<T>( calcRate_r(y), calcRate_theta(y), calcRate_z(y), 
+						calcRate_vrEarth(y, mu), calcRate_vthetaEarth(y),
+						calcRate_vzEarth(y, mu));
+}
+
+template <class T> __host__ __device__ elements<T> calc_kFromRate(const T & h, const elements<T> & rate, const thrustAngles<T> & angles, const T & accel) {
+	return elements<T>( h*rate.r, h*rate.theta, h*rate.z, 
+						h*(rate.vr + accel*angles.cosTau*angles.sinGamma), h*(rate.vtheta + accel*angles.cosTau*angles.cosGamma),
+						h*(rate.vz + accel*angles.sinTau));
+}
+
 template <class T>  __host__ __device__ T calcRate_r(const elements<T> & y) {
 	return y.vr;
 }
@@ -29,27 +55,35 @@ template <class T>  __host__ __device__ T calcRate_z(const elements<T> & y) {
 	return y.vz;
 }
 
-template <class T> __host__ __device__ T calcRate_vr(const elements<T> & y, coefficients<T> & coeff, const T & accel, const T & curTime, const T & timeFinal) {
+template <class T> __host__ __device__ T calcRate_vr(const elements<T> & y, const thrustAngles<T> & angles, const T & accel) {
 	return (-constG * massSun * y.r / (pow(pow(y.r, 2) + pow(y.z, 2), 1.5))) + (pow(y.vtheta,2) / y.r) +
-		(accel*cos(calc_tau(coeff,curTime, timeFinal))*sin(calc_gamma(coeff,curTime, timeFinal)));
+		(accel*angles.cosTau*angles.sinGamma);
 }
 
-template <class T> __host__ __device__ T calcRate_vtheta(const elements<T> & y, coefficients<T> & coeff, const T & accel, const T & curTime, const T & timeFinal) {
-	return -y.vr*y.vtheta / y.r + accel*cos(calc_tau(coeff,curTime, timeFinal))*cos(calc_gamma(coeff,curTime, timeFinal));
+template <class T> __host__ __device__ T calcRate_vtheta(const elements<T> & y, const thrustAngles<T> & angles, const T & accel) {
+	return -y.vr*y.vtheta / y.r + accel*angles.cosTau*angles.cosGamma;
 }
 
-template <class T> __host__ __device__ T calcRate_vz(const elements<T> & y, coefficients<T> & coeff, const T & accel, const T & curTime, const T & timeFinal) {
-	return (-constG * massSun * y.z / pow(pow(y.r, 2) + pow(y.z, 2), 1.5)) + accel*sin(calc_tau(coeff,curTime, timeFinal));
+template <class T> __host__ __device__ T calcRate_vz(const elements<T> & y, const thrustAngles<T> & angles, const T & accel) {
+	return (-constG * massSun * y.z / pow(pow(y.r, 2) + pow(y.z, 2), 1.5)) + accel*angles.sinTau;
 }
 
-template <class T> __host__ __device__ T calcRate_vrEarth(const elements<T> & y) {
-	return (-constG * massSun * y.r / (pow(pow(y.r, 2) + pow(y.z, 2), 1.5))) + (pow(y.vtheta,2) / y.r);
+template <class T> __host__ __device__ T calcRate_vrEarth(const elements<T> & y, const T & mu) {
+	return (-mu * y.r / (pow(pow(y.r, 2) + pow(y.z, 2), 1.5))) + (pow(y.vtheta,2) / y.r);
 }
 
 template <class T> __host__ __device__ T calcRate_vthetaEarth(const elements<T> & y) {
 	return -y.vr*y.vtheta / y.r;
 }
 
-template <class T> __host__ __device__ T calcRate_vzEarth(const elements<T> & y) {
-	return (-constG * massSun * y.z / pow(pow(y.r, 2) + pow(y.z, 2), 1.5));
+template <class T> __host__ __device__ T calcRate_vzEarth(const elements<T> & y, const T & mu) {
+	return (-mu * y.z / pow(pow(y.r, 2) + pow(y.z, 2), 1.5));
+}
+
+template <class T> __host__ __device__ elements<T> toTimeUnit(const elements<T> & y, const T & timeUnit) {
+	return elements<T>(y.r, y.theta, y.z, y.vr*timeUnit, y.vtheta*timeUnit, y.vz*timeUnit);
+}
+
+template <class T> __host__ __device__ elements<T> fromTimeUnit(const elements<T> & y, const T & timeUnit) {
+	return elements<T>(y.r, y.theta, y.z, y.vr/timeUnit, y.vtheta/timeUnit, y.vz/timeUnit);
 }
\ No newline at end of file
@@ -15,15 +15,35 @@
 // Input:
 //      y: current position and velocity conditions
 //      h(time step): time interval between data points (s)
-//      coeff: coefficients structure components for the current time stamp
+//      profile: where the thrust angles come from, coefficients structure of the individual or a thrustTable built from it
 //      accel: acceleration of the spacecraft (au/s^s)
 //      curTime: current time stamp (s)
 //      totalTime: the complete time frame of the simulation (s), used to normalize curTime
 //Output: returns k1,k2,k3,k4 for y[n+1] calculation
-template <class T> __host__ __device__ elements<T> calc_k(const T & h, const elements<T> & y, coefficients<T> & coeff, const T & accel, const T & curTime, const T & timeFinal);
+template <class T, class P> __host__ __device__ elements<T> calc_k(const T & h, const elements<T> & y, P & profile, const T & accel, const T & curTime, const T & timeFinal);
+
+// Same as above, but with the thrust angles for the stage time already evaluated by calc_stageAngles()
+// Lets stages at the same time (k6 and k7 in rkCalc()) share one evaluation of the Fourier series
+template <class T> __host__ __device__ elements<T> calc_k(const T & h, const elements<T> & y, const thrustAngles<T> & angles, const T & accel);
+
+// Thrust angles for one runge kutta stage, evaluated once and used by all three velocity rates
+// Input: profile, curTime, timeFinal - passed to calc_thrustAngles()
+//        accel: acceleration of the spacecraft (au/s^2), when 0 the Fourier series are skipped and the angles are left at 0
+// Output: thrustAngles for the stage
+template <class T, class P> __host__ __device__ thrustAngles<T> calc_stageAngles(P & profile, const T & accel, const T & curTime, const T & timeFinal);
 
 template <class T> __host__ __device__ elements<T> calc_kEarth(const T & h, const elements<T>  & y, const T & curTime, const T & timeFinal);
 
+// Derivative of y under the sun's gravity alone, without a step size (calc_kEarth() is this times h)
+// Found once per value and used by calc_kFromRate(), so a stage at a value a rate is already known at (the first stage of a
+// step after a first same as last step) does not evaluate the gravity again
+// mu is the sun's gravitational parameter in the units of y, 1 when y is in canonical units (see toTimeUnit())
+template <class T> __host__ __device__ elements<T> calc_gravityRate(const elements<T> & y, const T & mu = constG * massSun);
+
+// Same as calc_k(), but from calc_gravityRate() of y with the thrust added here
+// The terms are added in the same order as calcRate_vr() and the others, so the result is the same as calc_k()'s
+template <class T> __host__ __device__ elements<T> calc_kFromRate(const T & h, const elements<T> & rate, const thrustAngles<T> & angles, const T & accel);
+
 // Dot = derivative of element with respect to time
 // Utilities of calc_k(), calculates the element from current condition
 // Parameter y: complete current condition
@@ -41,26 +61,36 @@ template <class T> __host__ __device__ T calcRate_theta(const elements<T> & y);
 template <class T> __host__ __device__ T calcRate_z(const elements<T> & y);
 
 // other parameters for following equations:
-//      coeff: coefficients structure components for the current time stamp
+//      angles: thrust angles (and their sines and cosines) at the current time stamp, from calc_stageAngles()
 //      accel: acceleration of the spacecraft (au/s^s)
-//      curTime: current time stamp (s)
-//      totalTime: the complete time frame of the simulation (s), used to normalize curTime
 
 // Based on: (-g * M_sun * r)  / (r^2 + z^2) ^ 3/2 + v_theta^2 / r + accel*cos(tau)*sin(gamma)
 // Output: vrDot
-template <class T> __host__ __device__ T calcRate_vr(const elements<T> & y, coefficients<T> & coeff, const T & accel, const T & curTime, const T & timeFinal);
+template <class T> __host__ __device__ T calcRate_vr(const elements<T> & y, const thrustAngles<T> & angles, const T & accel);
 
 // Based on: -vr*vtheta / r + accel*cos(tau)*cos(gamma)
 // Output: vrDot
-template <class T> __host__ __device__ T calcRate_vtheta(const elements<T> & y, coefficients<T> & coeff, const T & accel, const T & curTime, const T & timeFinal);
+template <class T> __host__ __device__ T calcRate_vtheta(const elements<T> & y, const thrustAngles<T> & angles, const T & accel);
 
 // Based on: (-g * M_sun * r)  / (r^2 + z^2) ^ 3/2 + + accel*sin(tau)
 // Output: vrDot
-template <class T> __host__ __device__ T calcRate_vz(const elements<T> & y, coefficients<T> & coeff, const T & accel, const T & curTime, const T & timeFinal);
+template <class T> __host__ __device__ T calcRate_vz(const elements<T> & y, const thrustAngles<T> & angles, const T & accel);
 
-template <class T> __host__ __device__ T calcRate_vrEarth(const elements<T> & y);
+// mu: the sun's gravitational parameter, as in calc_gravityRate()
+template <class T> __host__ __device__ T calcRate_vrEarth(const elements<T> & y, const T & mu = constG * massSun);
 template <class T> __host__ __device__ T calcRate_vthetaEarth(const elements<T> & y);
-template <class T> __host__ __device__ T calcRate_vzEarth(const elements<T> & y);
+template <class T> __host__ __device__ T calcRate_vzEarth(const elements<T> & y, const T & mu = constG * massSun);
+
+// Canonical units, used in the integration when canonical_units is true
+// Positions stay in AU and time is in canonicalTime (TU, about 58 days), where the sun's gravitational parameter is 1 AU^3/TU^2,
+// so the velocities (about 1e-7 AU/s) and times (about 1e8 s) of a trip are both near 1
+// Input: y - position and velocity with its velocities in AU/s
+//        timeUnit - seconds in the unit of time to change to (canonicalTime)
+// Output: y with its velocities in AU per timeUnit, theta and the positions are unchanged
+template <class T> __host__ __device__ elements<T> toTimeUnit(const elements<T> & y, const T & timeUnit);
+
+// Inverse of toTimeUnit(), y with its velocities in AU per timeUnit back to AU/s
+template <class T> __host__ __device__ elements<T> fromTimeUnit(const elements<T> & y, const T & timeUnit);
 
 #include "motion_equations.cpp"
 
@@ -0,0 +1,119 @@
+// Times the integration of individuals with and without the last stage of each step carried to the next (carry_stage in genetic.config)
+// Compiled the same way as optimization.cu, run from the Optimization folder with
+//      benchCarry.exe [number of individuals] [repeats] [seed]
+// By default 1000 random individuals from seed 1 (not time_seed, so runs can be repeated), each integrated 3 times both ways on one thread with the step_control,
+// rk_tableau, and cpu_simd_batch of genetic.config, without pruning. The fastest of the repeats is reported for each, as time per trajectory
+// DOP853 is not first same as last, so it takes the same time both ways
+
+#include "../Earth_calculations/earthInfo.h"  // For the config, launchCon, and EarthInfo()
+#include "../Genetic_Algorithm/individuals.h" // For Individual and randomParameters()
+#include "../Runge_Kutta/runge_kuttaCPU.h"    // For rk4SimpleIndividual() and rk4SimpleBatch()
+
+#include <iostream> // cout
+#include <string>   // std::stoi and std::stoull for the arguments
+#include <chrono>   // steady_clock to time each pass
+#include <random>   // for std::mt19937_64 object
+
+// Integrates copies of the individuals once, the same way callRKCPU() does on each thread
+// Input: start - individuals to integrate, count - size of start, cConstants - carry_stage set to the way being timed
+// Output: results - start integrated, returns the time taken (s)
+double timePass(const Individual *start, Individual *results, int count, const cudaConstants* cConstants) {
+    for (int i = 0; i < count; i++) {
+        results[i] = start[i];
+    }
+    double timeInitial = 0;
+    double stepSize = (orbitalPeriod - timeInitial) / cConstants->GuessMaxPossibleSteps;
+    double absTol = cConstants->rk_tol;
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    if (cConstants->cpu_simd_batch) {
+        rk4SimpleBatch(results, count, timeInitial, stepSize, absTol, cConstants);
+    }
+    else {
+        for (int i = 0; i < count; i++) {
+            rk4SimpleIndividual(results[i], timeInitial, stepSize, absTol, cConstants, nullptr);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    cudaConstants * cConstants = new cudaConstants("../Config_Constants/genetic.config");
+
+    int count = 1000;
+    int repeats = 3;
+    unsigned long long seed = 1;
+    if (argc > 1) {
+        count = std::stoi(argv[1]);
+    }
+    if (argc > 2) {
+        repeats = std::stoi(argv[2]);
+    }
+    if (argc > 3) {
+        seed = std::stoull(argv[3]);
+    }
+    if (count < 1 || repeats < 1) {
+        std::cout << "Number of individuals and repeats must be at least 1\n";
+        delete cConstants;
+        return 1;
+    }
+
+    launchCon = new EarthInfo(cConstants);
+
+    // The same individuals every time for the same seed
+    std::mt19937_64 rng(seed);
+    Individual *start = new Individual[count];
+    for (int i = 0; i < count; i++) {
+        rkParameters<double> params = randomParameters(rng, cConstants);
+        start[i] = Individual(params, cConstants);
+    }
+    Individual *carried = new Individual[count];
+    Individual *found = new Individual[count];
+
+    // The two ways take turns so a change in the machine's speed during the run affects both
+    double carriedTime = -1;
+    double foundTime = -1;
+    for (int r = 0; r < repeats; r++) {
+        cConstants->carry_stage = true;
+        double time = timePass(start, carried, count, cConstants);
+        if (carriedTime < 0 || time < carriedTime) {
+            carriedTime = time;
+        }
+        cConstants->carry_stage = false;
+        time = timePass(start, found, count, cConstants);
+        if (foundTime < 0 || time < foundTime) {
+            foundTime = time;
+        }
+    }
+
+    // Carrying the stage should not change the results, the largest difference is shown to check
+    // (individuals that came too close to the sun have NaN results both ways and are skipped by the comparisons)
+    double maxPosDiff = 0;
+    double maxVelDiff = 0;
+    for (int i = 0; i < count; i++) {
+        double posDiff = std::abs(carried[i].posDiff - found[i].posDiff);
+        double velDiff = std::abs(carried[i].velDiff - found[i].velDiff);
+        if (posDiff > maxPosDiff) {
+            maxPosDiff = posDiff;
+        }
+        if (velDiff > maxVelDiff) {
+            maxVelDiff = velDiff;
+        }
+    }
+
+    std::cout << count << " individuals from seed " << seed << ", fastest of " << repeats << " repeats, step_control=" << (cConstants->step_control == cudaConstants::PI_STEP ? "PI" : "SCALE")
+              << " rk_tableau=" << (cConstants->rk_tableau == cudaConstants::DOP853_TABLEAU ? "DOP853" : (cConstants->rk_tableau == cudaConstants::VERNER65_TABLEAU ? "VERNER65" : "DP5"))
+              << " cpu_simd_batch=" << cConstants->cpu_simd_batch << "\n";
+    std::cout << "\tcarry_stage=true:  " << carriedTime/count*1e6 << " us per trajectory\n";
+    std::cout << "\tcarry_stage=false: " << foundTime/count*1e6 << " us per trajectory\n";
+    std::cout << "\ttime saved by carrying the stage: " << (1 - carriedTime/foundTime)*100 << "%\n";
+    std::cout << "\tlargest difference in results: " << maxPosDiff << " AU posDiff, " << maxVelDiff << " AU/s velDiff\n";
+
+    delete [] start;
+    delete [] carried;
+    delete [] found;
+    delete launchCon;
+    delete cConstants;
+    return 0;
+}
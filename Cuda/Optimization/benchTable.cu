@@ -0,0 +1,133 @@
+// Times the integration of individuals with their thrust angles and coast value interpolated from a thrustTable (thrust_table_tol in genetic.config)
+// against evaluating the Fourier series, for a range of tolerances. Compiled the same way as optimization.cu, run from the Optimization folder with
+//      benchTable.exe [number of individuals] [repeats] [seed]
+// By default 1000 random individuals from seed 1 (not time_seed, so runs can be repeated), each integrated 3 times for each tolerance on one thread
+// with the step_control, rk_tableau, and cpu_simd_batch of genetic.config, without pruning. The fastest of the repeats is reported for each, as time
+// per trajectory including building the tables, with how many individuals could not meet the tolerance and used the Fourier series
+// and the largest difference in results from the series
+
+#include "../Earth_calculations/earthInfo.h"  // For the config, launchCon, and EarthInfo()
+#include "../Genetic_Algorithm/individuals.h" // For Individual and randomParameters()
+#include "../Runge_Kutta/runge_kuttaCPU.h"    // For rk4SimpleIndividual(), rk4SimpleBatch(), and initThrustTable()
+
+#include <iostream> // cout
+#include <string>   // std::stoi and std::stoull for the arguments
+#include <chrono>   // steady_clock to time each pass
+#include <random>   // for std::mt19937_64 object
+
+// Tolerances timed against the Fourier series, from where every table is built to where none can be
+const double benchTolerances[] = {1e-3, 1e-4, 1e-5, 1e-6, 1e-8};
+
+// Integrates copies of the individuals once, the same way rkCPUWorker() does on each thread
+// Input: start - individuals to integrate, count - size of start, cConstants - thrust_table_tol set to the tolerance being timed (0 for the series),
+//        tables - RK_BATCH_LANES thrust tables reused for each individual
+// Output: results - start integrated, fallbacks - individuals that used the Fourier series because their table could not meet the tolerance,
+//         returns the time taken (s)
+double timePass(const Individual *start, Individual *results, int count, const cudaConstants* cConstants, thrustTable<double> *tables, int & fallbacks) {
+    for (int i = 0; i < count; i++) {
+        results[i] = start[i];
+    }
+    double timeInitial = 0;
+    double stepSize = (orbitalPeriod - timeInitial) / cConstants->GuessMaxPossibleSteps;
+    double absTol = cConstants->rk_tol;
+    double tableTol = cConstants->thrust_table_tol;
+    fallbacks = 0;
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    if (cConstants->cpu_simd_batch) {
+        rk4SimpleBatch(results, count, timeInitial, stepSize, absTol, cConstants, tableTol > 0 ? tables : nullptr, nullptr, &fallbacks);
+    }
+    else {
+        for (int i = 0; i < count; i++) {
+            if (tableTol > 0 && initThrustTable(*tables, results[i].startParams.coeff, tableTol)) {
+                rk4SimpleIndividual(results[i], *tables, timeInitial, stepSize, absTol, cConstants, nullptr);
+            }
+            else {
+                if (tableTol > 0) {
+                    fallbacks++;
+                }
+                rk4SimpleIndividual(results[i], timeInitial, stepSize, absTol, cConstants, nullptr);
+            }
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    cudaConstants * cConstants = new cudaConstants("../Config_Constants/genetic.config");
+
+    int count = 1000;
+    int repeats = 3;
+    unsigned long long seed = 1;
+    if (argc > 1) {
+        count = std::stoi(argv[1]);
+    }
+    if (argc > 2) {
+        repeats = std::stoi(argv[2]);
+    }
+    if (argc > 3) {
+        seed = std::stoull(argv[3]);
+    }
+    if (count < 1 || repeats < 1) {
+        std::cout << "Number of individuals and repeats must be at least 1\n";
+        delete cConstants;
+        return 1;
+    }
+
+    launchCon = new EarthInfo(cConstants);
+
+    // The same individuals every time for the same seed
+    std::mt19937_64 rng(seed);
+    Individual *start = new Individual[count];
+    for (int i = 0; i < count; i++) {
+        rkParameters<double> params = randomParameters(rng, cConstants);
+        start[i] = Individual(params, cConstants);
+    }
+    Individual *series = new Individual[count];
+    Individual *tabled = new Individual[count];
+    thrustTable<double> *tables = new thrustTable<double>[RK_BATCH_LANES];
+
+    std::cout << count << " individuals from seed " << seed << ", fastest of " << repeats << " repeats, step_control=" << (cConstants->step_control == cudaConstants::PI_STEP ? "PI" : "SCALE")
+              << " rk_tableau=" << (cConstants->rk_tableau == cudaConstants::DOP853_TABLEAU ? "DOP853" : (cConstants->rk_tableau == cudaConstants::VERNER65_TABLEAU ? "VERNER65" : "DP5"))
+              << " cpu_simd_batch=" << cConstants->cpu_simd_batch << "\n";
+
+    int fallbacks = 0;
+    for (double tol : benchTolerances) {
+        // The series and the table take turns so a change in the machine's speed during the run affects both
+        double seriesTime = -1;
+        double tableTime = -1;
+        for (int r = 0; r < repeats; r++) {
+            cConstants->thrust_table_tol = 0;
+            double time = timePass(start, series, count, cConstants, tables, fallbacks);
+            if (seriesTime < 0 || time < seriesTime) {
+                seriesTime = time;
+            }
+            cConstants->thrust_table_tol = tol;
+            time = timePass(start, tabled, count, cConstants, tables, fallbacks);
+            if (tableTime < 0 || time < tableTime) {
+                tableTime = time;
+            }
+        }
+
+        // (individuals that came too close to the sun have NaN results both ways and are skipped by the comparison)
+        double maxPosDiff = 0;
+        for (int i = 0; i < count; i++) {
+            double posDiff = std::abs(tabled[i].posDiff - series[i].posDiff);
+            if (posDiff > maxPosDiff) {
+                maxPosDiff = posDiff;
+            }
+        }
+
+        std::cout << "\tthrust_table_tol=" << tol << ": " << tableTime/count*1e6 << " us per trajectory against " << seriesTime/count*1e6 << " for the series, "
+                  << (1 - tableTime/seriesTime)*100 << "% time saved, " << fallbacks << " used the series, largest difference in results: " << maxPosDiff << " AU posDiff\n";
+    }
+
+    delete [] start;
+    delete [] series;
+    delete [] tabled;
+    delete [] tables;
+    delete launchCon;
+    delete cConstants;
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Builds the Chebyshev ephemeris files (see Earth_calculations/ephemeris.h) for Earth and the target body
+// Compiled the same way as optimization.cu, run from the Optimization folder with
+//      buildEphemeris.exe [segment length in days] [degree] [start time in years] [end time in years]
+// Times are backwards from the impact date, by default 32 day segments of degree 12 over triptime_min to triptime_max from genetic.config
+// Earth's file is written to earth_ephemeris, which EarthInfo reads when earth_mode=EPHEMERIS, and the target's to targetEphemeris.bin next to it
+
+#include "../Earth_calculations/earthInfo.h" // For the config, rk4Reverse(), ephemeris.h, and kepler.h
+
+#include <iostream> // cout
+#include <string>   // std::stod and std::stoi for the arguments
+
+// Builds and writes one body's ephemeris, then checks it between the nodes against the body's closed form two body motion
+// Input: name - body name to display, epoch - body's conditions at impact, fileName - file to write, other inputs passed to buildEphemeris()
+void buildBody(const std::string & name, const elements<double> & epoch, const std::string & fileName, const double & startTime, const double & endTime,
+               const double & segmentLength, const int & degree, const cudaConstants* cConstants) {
+    ephemerisHeader header;
+    double *coeff = buildEphemeris(epoch, startTime, endTime, segmentLength, degree, cConstants, header);
+
+    // Largest difference from keplerPropagate() at points spread through each segment
+    cartesianState<double> epochState = cylindricalToCartesian(epoch);
+    double maxPosError = 0;
+    double maxVelError = 0;
+    for (int64_t s = 0; s < header.segmentCount; s++) {
+        for (int p = 0; p < 7; p++) {
+            double x = -1 + (p + 0.5)*2/7;
+            double time = header.startTime + (s + (x + 1)/2)*segmentLength;
+            elements<double> fit = clenshaw(coeff + s*(degree + 1)*6, degree, x);
+            elements<double> exact = cartesianToCylindrical(keplerPropagate(epochState, -time, static_cast<double>(constG * massSun)), fit.theta);
+
+            elements<double> diff = fit - exact;
+            double posError = sqrt(diff.r*diff.r + exact.r*exact.r*diff.theta*diff.theta + diff.z*diff.z);
+            double velError = sqrt(diff.vr*diff.vr + diff.vtheta*diff.vtheta + diff.vz*diff.vz);
+            if (posError > maxPosError) {
+                maxPosError = posError;
+            }
+            if (velError > maxVelError) {
+                maxVelError = velError;
+            }
+        }
+    }
+
+    if (writeEphemeris(fileName, header, coeff)) {
+        std::cout << name << ": " << header.segmentCount << " segments, " << sizeof(ephemerisHeader) + header.segmentCount*(degree + 1)*6*sizeof(double)
+                  << " bytes written to " << fileName << "\n";
+    }
+    else {
+        std::cout << name << ": could not write " << fileName << "\n";
+    }
+    std::cout << "\tlargest difference from two body motion between nodes: " << maxPosError << " AU, " << maxVelError << " AU/s\n";
+
+    delete [] coeff;
+}
+
+int main(int argc, char* argv[]) {
+    cudaConstants * cConstants = new cudaConstants("../Config_Constants/genetic.config");
+
+    double segmentLength = 32*24*3600.0;
+    int degree = 12;
+    double startTime = cConstants->triptime_min;
+    double endTime = cConstants->triptime_max;
+    if (argc > 1) {
+        segmentLength = std::stod(argv[1])*24*3600;
+    }
+    if (argc > 2) {
+        degree = std::stoi(argv[2]);
+    }
+    if (argc > 3) {
+        startTime = std::stod(argv[3])*SECONDS_IN_YEAR;
+    }
+    if (argc > 4) {
+        endTime = std::stod(argv[4])*SECONDS_IN_YEAR;
+    }
+    if (degree < 1 || degree > EPHEMERIS_MAX_DEGREE || segmentLength <= 0 || startTime < 0 || endTime <= startTime) {
+        std::cout << "Segment length must be above 0, degree from 1 to " << EPHEMERIS_MAX_DEGREE << ", and 0 <= start time < end time\n";
+        delete cConstants;
+        return 1;
+    }
+
+    std::cout << "Building ephemeris files from " << startTime << " s to " << endTime << " s before impact, " << segmentLength << " s segments of degree " << degree << "\n";
+
+    elements<double> earth = elements<double>(cConstants->r_fin_earth, cConstants->theta_fin_earth, cConstants->z_fin_earth, cConstants->vr_fin_earth, cConstants->vtheta_fin_earth, cConstants->vz_fin_earth);
+    elements<double> target = elements<double>(cConstants->r_fin_ast, cConstants->theta_fin_ast, cConstants->z_fin_ast, cConstants->vr_fin_ast, cConstants->vtheta_fin_ast, cConstants->vz_fin_ast);
+
+    std::string folder = cConstants->earth_ephemeris.substr(0, cConstants->earth_ephemeris.find_last_of("/\\") + 1);
+    buildBody("Earth", earth, cConstants->earth_ephemeris, startTime, endTime, segmentLength, degree, cConstants);
+    buildBody("Target", target, folder + "targetEphemeris.bin", startTime, endTime, segmentLength, degree, cConstants);
+
+    delete cConstants;
+    return 0;
+}
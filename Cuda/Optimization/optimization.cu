@@ -6,7 +6,11 @@
 #include "../Genetic_Algorithm/individuals.h" // For individual structs, paths to rkParameters for randomParameters()
 #include "../Output_Funcs/output.h" // For terminalDisplay(), recordGenerationPerformance(), and finalRecord()
 #include "../Runge_Kutta/runge_kuttaCUDA.cuh" // for testing rk4simple
+#include "../Runge_Kutta/runge_kuttaCPU.h" // for callRKCPU() and cpuPool
+#include "../Runge_Kutta/parareal.h" // for verifyFinalists()
 #include "../Genetic_Algorithm/ga_crossover.h" // for selectSurvivors() and newGeneration()
+#include "../Genetic_Algorithm/generationEngine.h" // for GenerationEngine, holds the population buffers
+#include "../Output_Funcs/allocCounter.h" // for heapAllocations(), to record the allocations made each generation
 
 #include <iostream> // cout
 #include <iomanip>  // used for setw(), sets spaces between values output
@@ -53,6 +57,23 @@ bool allWithinTolerance(double tolerance, Individual * pool, const cudaConstants
     return true;
 }
 
+// Evaluates individuals on the backend set by rk_backend
+// Input: count, individuals - the individuals to calculate the trajectories of
+//        timeInitial, stepSize, absTol - passed to callRK() or callRKCPU()
+//        cConstants - config to integrate with, the run's config or FitnessScreen's coarse copy
+//        arenas - scratch memory for callRKCPU(), from the GenerationEngine
+//        prune - cutoffs to prune trajectories against, from the GenerationEngine, nullptr for none
+// Output: individuals have finalPos, posDiff, velDiff, cost, and prunedTime set, calcPerS is set by the backend
+// Called inside of optimize for each pass of evaluating new individuals
+void evaluateIndividuals(int count, Individual * individuals, double timeInitial, double stepSize, double absTol, double & calcPerS, const cudaConstants* cConstants, ScratchArena * arenas, const pruneBounds * prune) {
+    if (cConstants->rk_backend == cudaConstants::CPU_BACKEND) {
+        callRKCPU(count, cConstants->thread_block_size, individuals, timeInitial, stepSize, absTol, calcPerS, cConstants, arenas, prune);
+    }
+    else {
+        callRK(count, cConstants->thread_block_size, individuals, timeInitial, stepSize, absTol, calcPerS, cConstants, prune);
+    }
+}
+
 // Main processing function for Genetic Algorithm
 // - manages memory needs for genetic algorithm
 // - deals with processing calls to CUDA callRK
@@ -62,7 +83,7 @@ double optimize(const cudaConstants* cConstants) {
     double calcPerS = 0;
 
     time_t timeSeed = cConstants->time_seed;
-    std::mt19937_64 rng(timeSeed); // This rng object is used for generating all random numbers in the genetic algorithm, passed in to functions that need it
+    std::mt19937_64 rng(timeSeed); // This rng object is used for the random starting individuals, newGeneration() uses counterRng streams keyed by time_seed instead
     
     std::cout << "----------------------------------------------------------------------------------------------------" << std::endl;
        
@@ -84,9 +105,13 @@ double optimize(const cudaConstants* cConstants) {
     // Initial genetic anneal scalar
     double currentAnneal = cConstants->anneal_initial;
 
+    // Holds the population buffers, survivors, and each thread's scratch memory for this run
+    GenerationEngine engine(cConstants);
+
     // Main set of parameters for Genetic Algorithm
     // contains all thread unique input parameters
-    Individual *inputParameters = new Individual[cConstants->num_individuals]; 
+    // points to engine's current buffer, so is updated after each nextGeneration()
+    Individual *inputParameters = engine.population();
 
     // set to zero to force difference in first generation
     double previousBestPos = 0; 
@@ -153,7 +178,7 @@ double optimize(const cudaConstants* cConstants) {
     // Collection of individuals used in the genetic selection process
     //  - filled in selectSurvivors, based on callRK output
     //  - stores the winners of the head-to-head competition
-    Individual *survivors = new Individual[cConstants->survivor_count]; 
+    Individual *survivors = engine.getSurvivors();
 
     // Number of individuals that need to be evaluated
     // - the whole population is in first loop
@@ -182,13 +207,50 @@ double optimize(const cudaConstants* cConstants) {
     // main gentic algorithm loop
     // - continues until allWithinTolerance returns true (specific number of individuals are within threshold)
     do {
+        // Heap allocations made by this generation, not counting the record files and terminal output
+        uint64_t allocStart = heapAllocations();
+        uint64_t genAllocations = 0;
+
         // each inputParameter represents an individual set of starting parameters
-        // GPU based runge kutta process determines final position and velocity based on parameters
+        // GPU (or CPU) based runge kutta process determines final position and velocity based on parameters
         // newInd - how many individuals that are *new* that need to be evaluated
         //        - All individuals first generation
         //        - only new individuals, from crossover, in subsequent generations
         // (inputParameters + (cConstants->num_individuals - newInd)) value accesses the start of the section of the inputParameters array that contains new individuals
-        callRK(newInd, cConstants->thread_block_size, inputParameters + (cConstants->num_individuals - newInd), timeInitial, stepSize, absTol, calcPerS, cConstants); // calculate trajectories for new individuals
+        // New individuals that repeat an already evaluated genome get its results from the fitness cache (if fitness_cache_size is set),
+        // evalCount is how many are left, engine.getToEvaluate() is where they are
+        int evalCount = engine.findCached(newInd, generation);
+        if (evalCount > 0) {
+            if (engine.getScreen() != nullptr) {
+                // Coarse pass over all of them (screen_max_numsteps), then only the ones that could be survivors are integrated again with the full config
+                // the individuals before the new ones are the kept individuals, with results from their own generation
+                FitnessScreen *screen = engine.getScreen();
+                const cudaConstants *coarse = screen->getCoarseConstants();
+                evaluateIndividuals(evalCount, engine.getToEvaluate(), timeInitial, stepSize, coarse->rk_tol, calcPerS, coarse, engine.getArenas(), engine.getPruneBounds());
+                int refineCount = screen->chooseRefine(inputParameters, cConstants->num_individuals - newInd, engine.getToEvaluate(), evalCount);
+                if (refineCount > 0) {
+                    evaluateIndividuals(refineCount, screen->getRefine(), timeInitial, stepSize, absTol, calcPerS, cConstants, engine.getArenas(), engine.getPruneBounds());
+                }
+                screen->finishRefine(engine.getToEvaluate());
+            }
+            else {
+                evaluateIndividuals(evalCount, engine.getToEvaluate(), timeInitial, stepSize, absTol, calcPerS, cConstants, engine.getArenas(), engine.getPruneBounds()); // calculate trajectories for new individuals
+            }
+        }
+        // Tables that cannot meet thrust_table_tol fall back to the Fourier series, shown for the first generation so a tolerance too tight to help is noticed
+        // (every generation's count is in loadBalance-[time_seed].csv in record_mode)
+        if (generation == 0 && evalCount > 0 && cConstants->rk_backend == cudaConstants::CPU_BACKEND && cConstants->thrust_table_tol > 0) {
+            loadBalanceSummary summary = rkScheduler->getSummary();
+            std::cout << "thrust_table_tol: " << summary.tableFallbacks << " of " << summary.items << " individuals could not meet it with "
+                      << THRUST_TABLE_MAX_NODES << " table points and used the Fourier series" << std::endl;
+        }
+        // How many were pruned, counted before rankGeneration() moves the cutoffs on
+        pruneStats pruneCounts = {0, 0, 0, 0, 0};
+        if (engine.getPruneBounds() != nullptr && evalCount > 0) {
+            pruneCounts = countPruned(engine.getToEvaluate(), evalCount, *engine.getPruneBounds());
+        }
+        // Results go into the cache and out to the new individuals
+        engine.storeEvaluated();
 
         // if we got bad results reset the Individual to random starting values (it may still be used for crossover) and set the final position to be way off so it gets replaced by a new Individual
         for (int k = 0; k < cConstants->num_individuals; k++) {
@@ -205,17 +267,23 @@ double optimize(const cudaConstants* cConstants) {
                 inputParameters[k].getCost(cConstants);
              }
         }
+        // Order the generation by cost, posDiff, and velDiff
+        // Only the newInd new individuals are sorted, then merged into the kept individuals' orderings from the last generation
+        engine.rankGeneration(newInd);
+
         // Preparing survivor pool with individuals for the newGeneration crossover
         // Survivor pool contains:
         //               - individuals with best PosDiff
         //               - individuals with best velDiffs
         //               - depends on cConstants->survivorRatio (0.1 is 10% are best PosDiff for example)
-        // inputParameters is left sorted by individuals with best velDiffs 
-        selectSurvivors(inputParameters, cConstants->num_individuals, cConstants->survivor_count, survivors, cConstants->survivorRatio); // Choose which individuals are in survivors, current method selects half to be best posDiff and other half to be best velDiff
+        // Taken from the engine's orderings, inputParameters is left as it is
+        selectSurvivors(inputParameters, cConstants->survivor_count, survivors, cConstants->survivorRatio, engine.getPosOrder(), engine.getVelOrder()); // Choose which individuals are in survivors, current method selects half to be best posDiff and other half to be best velDiff
 
-        // sort individuals based on overloaded relational operators
+        // sort individuals by cost (as with the overloaded relational operators)
         // gives reference of which to replace and which to carry to the next generation
-        std::sort(inputParameters, inputParameters + cConstants->num_individuals);
+        // the kept individuals are gathered in rankGeneration()'s cost order into the engine's other buffer
+        engine.sortByCost();
+        inputParameters = engine.population();
 
         // Display a '.' to the terminal to show that a generation has been performed
         // This also serves to visually seperate the terminalDisplay() calls across generations 
@@ -254,9 +322,27 @@ double optimize(const cudaConstants* cConstants) {
             previousBestVel = currentBest.velDiff;
         }
 
+        genAllocations += heapAllocations() - allocStart;
+
         // If in recording mode and write_freq reached, call the record method
         if (static_cast<int>(generation) % cConstants->write_freq == 0 && cConstants->record_mode == true) {
             recordGenerationPerformance(cConstants, inputParameters, generation, new_anneal, cConstants->num_individuals);
+            // Record how evenly the work was spread over the CPU threads
+            if (cConstants->rk_backend == cudaConstants::CPU_BACKEND) {
+                recordLoadBalance(cConstants, generation, rkScheduler->getSummary(), calcPerS);
+            }
+            // Record how many of the new individuals the fitness cache found
+            if (engine.getCache() != nullptr) {
+                recordFitnessCache(cConstants, generation, engine.getCache()->getStats());
+            }
+            // Record how many were refined after the coarse pass and how often it disagreed with the final results
+            if (engine.getScreen() != nullptr) {
+                recordScreening(cConstants, generation, engine.getScreen()->getStats());
+            }
+            // Record how many trajectories were stopped early
+            if (cConstants->prune_checkpoints > 0) {
+                recordPruning(cConstants, generation, pruneCounts);
+            }
         }
         
         // Only call terminalDisplay every DISP_FREQ, not every single generation
@@ -265,13 +351,20 @@ double optimize(const cudaConstants* cConstants) {
             terminalDisplay(inputParameters[0], generation);
         }
 
+        allocStart = heapAllocations();
+
         // Before replacing new individuals, determine whether all are within tolerance
         // Determines when loop is finished
         convergence = allWithinTolerance(tolerance, inputParameters, cConstants);
 
         // Create a new generation and increment the generation counter
         // Genetic Crossover and mutation occur here
-        newInd = newGeneration(survivors, inputParameters, cConstants->survivor_count, cConstants->num_individuals, new_anneal, cConstants, rng, generation);
+        newInd = engine.nextGeneration(new_anneal, generation);
+
+        genAllocations += heapAllocations() - allocStart;
+        if (static_cast<int>(generation) % cConstants->write_freq == 0 && cConstants->record_mode == true) {
+            recordAllocations(cConstants, generation, genAllocations, engine.scratchBytes());
+        }
         ++generation;
     
         //Loop exits based on result of allWithinTolerance and if max_generations has been hit
@@ -282,30 +375,55 @@ double optimize(const cudaConstants* cConstants) {
     if (cConstants->record_mode == true) {
         recordGenerationPerformance(cConstants, inputParameters, generation, -1, cConstants->num_individuals);
     }
+    // Overall fitness cache hit rate for the run
+    if (engine.getCache() != nullptr) {
+        fitnessCacheStats totals = engine.getCache()->getTotals();
+        std::cout << "\nFitness cache: " << totals.lookups - totals.evaluated << " of " << totals.lookups << " new individuals were not integrated (";
+        std::cout << totals.hits << " found in the cache, " << totals.repeats << " repeated within a generation)" << std::endl;
+    }
+    // Overall share of the screened individuals that were integrated again
+    if (engine.getScreen() != nullptr) {
+        screenStats totals = engine.getScreen()->getTotals();
+        std::cout << "\nFitness screen: " << totals.refined << " of " << totals.screened << " screened individuals were integrated again with the full config (";
+        std::cout << totals.selectionChanges << " changed sides of a survivor boundary, largest coarse posDiff error " << totals.maxPosDiffError << " AU)" << std::endl;
+    }
+
+    // Integrate the best individuals again at verify_tol, the ones kept from the last generation are at the front of the pool
+    if (cConstants->verify_count > 0) {
+        int keptCount = cConstants->num_individuals - newInd;
+        verifyFinalists(inputParameters, (cConstants->verify_count < keptCount) ? cConstants->verify_count : keptCount, cConstants);
+    }
+
     // Only call finalRecord if the results actually converged on a solution
     // also display last generation onto terminal
     if (convergence) {
         terminalDisplay(inputParameters[0], generation);
         finalRecord(cConstants, inputParameters, static_cast<int>(generation));
     }
-    
-    delete [] inputParameters;
-    delete [] survivors;
 
     return calcPerS;
 }
 
 int main () {
-    // display GPU properties and ensure we are using the right one
-    cudaDeviceProp prop;
-    cudaGetDeviceProperties(&prop, 0);
-    std::cout << "\n\nDevice Number: 0 \n";
-    std::cout << "- Device name: " << prop.name << std::endl << std::endl;
-    cudaSetDevice(0);
-    
     // Declare the genetic constants used, with file path being used to receive initial values
     cudaConstants * cConstants = new cudaConstants("../Config_Constants/genetic.config"); 
 
+    // start the CPU threads, used for making each new generation and in place of the GPU with the CPU backend
+    cpuPool = new ThreadPool(cConstants->cpu_threads);
+
+    if (cConstants->rk_backend == cudaConstants::CPU_BACKEND) {
+        rkScheduler = new WorkStealingScheduler(cpuPool->size());
+        std::cout << "\n\nCPU backend: " << cpuPool->size() << " threads" << std::endl << std::endl;
+    }
+    else {
+        // display GPU properties and ensure we are using the right one
+        cudaDeviceProp prop;
+        cudaGetDeviceProperties(&prop, 0);
+        std::cout << "\n\nDevice Number: 0 \n";
+        std::cout << "- Device name: " << prop.name << std::endl << std::endl;
+        cudaSetDevice(0);
+    }
+
     // Sets run0 seed, used to change seed between runs
     // Seed is set in cudaConstants: current time or passed in via config
     double zero_seed = cConstants->time_seed;
@@ -334,6 +452,9 @@ int main () {
     }
     // Now that the optimize function is done (assumed that optimize() also records it), deallocate memory of the cudaConstants
     delete cConstants;
+    // Stop the CPU threads
+    delete rkScheduler;
+    delete cpuPool;
     
     return 0;
 }
@@ -0,0 +1,43 @@
+uint64_t heapAllocations() {
+    return heapAllocationCount.load(std::memory_order_relaxed);
+}
+
+// Counts the allocation and takes it from malloc(), shared by operator new and operator new[]
+static void * countedAllocation(std::size_t size) {
+    heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    // malloc(0) may return nullptr, new must return a unique pointer
+    if (size == 0) {
+        size = 1;
+    }
+    void *address = std::malloc(size);
+    if (address == nullptr) {
+        throw std::bad_alloc();
+    }
+    return address;
+}
+
+void * operator new(std::size_t size) {
+    return countedAllocation(size);
+}
+
+// The library's operator new[] already calls operator new, it is replaced so each new[] is seen to be paired with a delete[] that calls free()
+void * operator new[](std::size_t size) {
+    return countedAllocation(size);
+}
+
+void operator delete(void * address) noexcept {
+    std::free(address);
+}
+
+void operator delete(void * address, std::size_t) noexcept {
+    std::free(address);
+}
+
+void operator delete[](void * address) noexcept {
+    std::free(address);
+}
+
+void operator delete[](void * address, std::size_t) noexcept {
+    std::free(address);
+}
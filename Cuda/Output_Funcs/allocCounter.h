@@ -0,0 +1,31 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <atomic>  // for counting from every thread
+#include <cstdint> // for uint64_t
+#include <cstdlib> // for malloc() and free()
+#include <new>     // for std::bad_alloc
+
+// Counts every host heap allocation made by the program, so the allocations made by each generation can be recorded
+// Done by replacing the global operator new and operator new[] (which the nothrow versions go through), and every operator delete
+// (unsized, sized, and array) so each delete is paired with the malloc() of operator new
+// Device memory (cudaMalloc) is not counted
+
+// Number of times operator new has been called since the program started
+std::atomic<uint64_t> heapAllocationCount(0);
+
+// Returns heapAllocationCount, take the difference of two calls to get the allocations made between them
+uint64_t heapAllocations();
+
+// Counts one allocation of size bytes and takes it from malloc(), throws std::bad_alloc if there is no memory
+static void * countedAllocation(std::size_t size);
+
+void * operator new(std::size_t size);
+void * operator new[](std::size_t size);
+void operator delete(void * address) noexcept;
+void operator delete(void * address, std::size_t size) noexcept;
+void operator delete[](void * address) noexcept;
+void operator delete[](void * address, std::size_t size) noexcept;
+
+#include "allocCounter.cpp"
+#endif
@@ -100,7 +100,8 @@ void recordMutateFile(const cudaConstants * cConstants, double generation, doubl
 //        generation - generation num of individual       
 //        cConstants - Access constants info such as target element, earth element, derive spaceCraft element, also other values such as rk_tol
 //        best - To access the best individual (pool[0])
-// output: file orbitalMotion-[time_seed].bin is created that holds spacecraft RK steps and error
+// output: file orbitalMotion-[time_seed].bin is created that holds the spacecraft's trajectory and error at cpu_numsteps even
+//         intervals of the trip, sampled from a DenseTrajectory integrated once with adaptive steps
 //         file finalOptimization-[time_seed].bin is created that holds earth/ast/ and trajectory parameter values
 void trajectoryPrint( double x[], int generation, const cudaConstants* cConstants, Individual best) {
   /*set the asteroid and inital conditions for the earth and spacecraft:
@@ -124,9 +125,8 @@ void trajectoryPrint( double x[], int generation, const cudaConstants* cConstant
   // setting time parameters
   double timeInitial=0; 
   double timeFinal=orbitalPeriod; // Orbital period of asteroid(s)
-  double deltaT; // time step
-  int numSteps = 5000; // initial guess for the number of time steps, guess for the memory allocated 
-  deltaT = (timeFinal-timeInitial) / cConstants->GuessMaxPossibleSteps; // initial guess for time step, small is preferable
+  double tripTime = x[TRIPTIME_OFFSET];
+  double deltaT = (timeFinal-timeInitial) / cConstants->GuessMaxPossibleSteps; // first step size to try, as individuals are evaluated with
 
   // setup of thrust angle calculations based off of optimized coefficients
   coefficients<double> coeff;
@@ -135,29 +135,44 @@ void trajectoryPrint( double x[], int generation, const cudaConstants* cConstant
 
   // Assigning wetMass
   double wetMass = cConstants->wet_mass;
-  // setting Runge-Kutta tolerance
-  double absTol = cConstants->rk_tol;
   // set optmization minimum
   // double Fmin = cConstants->f_min;
 
+  // integrate the trajectory of the input starting conditions once, keeping the dense output of every step
+  DenseTrajectory trajectory(spaceCraft, timeInitial, tripTime, coeff, deltaT, cConstants);
+
+  // The trajectory is sampled at cpu_numsteps even intervals of the trip for the output, lastStepInt is the index of the last sample
+  int lastStepInt = cConstants->cpu_numsteps;
+  int numSamples = lastStepInt + 1;
+
   // Initialize memory for the solution vector of the dependant solution
-  elements<double>* yp = new elements<double>[numSteps];
+  elements<double>* yp = new elements<double>[numSamples];
   
   double *times, *gamma, *tau, *accel_output, *fuelSpent, *work, *dE, *Etot_avg;
-  times = new double[numSteps]; // Initialize memory for time array
-  gamma = new double[numSteps]; // Initialize memory for gamma array
-  tau = new double[numSteps]; // Initialize memory for tau array
-  accel_output = new double[numSteps]; // Initialize memory for acceleration array
-  fuelSpent = new double[numSteps];  // Initialize memory for fuelSpent array
-  work = new double[numSteps];  // Initialize memory for work array
-  dE = new double[numSteps];  // Initialize memory for delta-E array
-  Etot_avg = new double[numSteps];  // Initialize memory for average mechanical energy array
-
-  // used to track the cost function throughout a run via output and outputs to a binary
-  int lastStepInt;
-
-  // integrate the trajectory of the input starting conditions
-  rk4sys(timeInitial, x[TRIPTIME_OFFSET] , times, spaceCraft, deltaT, yp, absTol, coeff, gamma, tau, lastStepInt, accel_output, fuelSpent, wetMass, cConstants);
+  times = new double[numSamples]; // Initialize memory for time array
+  gamma = new double[numSamples]; // Initialize memory for gamma array
+  tau = new double[numSamples]; // Initialize memory for tau array
+  accel_output = new double[numSamples]; // Initialize memory for acceleration array
+  fuelSpent = new double[numSamples];  // Initialize memory for fuelSpent array
+  work = new double[numSamples];  // Initialize memory for work array
+  dE = new double[numSamples];  // Initialize memory for delta-E array
+  Etot_avg = new double[numSamples];  // Initialize memory for average mechanical energy array
+
+  for (int i = 0; i <= lastStepInt; i++) {
+    // the last sample is at the end of the trip exactly
+    times[i] = (i == lastStepInt) ? tripTime : timeInitial + (tripTime - timeInitial) * i / lastStepInt;
+    yp[i] = trajectory.getCondition(times[i]);
+
+    if (cConstants->thruster_type == thruster<double>::NO_THRUST) {
+      gamma[i] = tau[i] = accel_output[i] = fuelSpent[i] = 0;
+    }
+    else {
+      gamma[i] = calc_gamma(coeff, times[i], tripTime);
+      tau[i] = calc_tau(coeff, times[i], tripTime);
+      accel_output[i] = trajectory.getAccel(times[i]);
+      fuelSpent[i] = trajectory.getFuelSpent(times[i]);
+    }
+  }
 
   // store the number of steps as a double for binary output
   double lastStep = lastStepInt;
@@ -165,6 +180,10 @@ void trajectoryPrint( double x[], int generation, const cudaConstants* cConstant
   // gets the final y values of the spacecrafts for the cost function.
   elements<double> yOut = yp[lastStepInt];
 
+  // Compare with the evaluation of the individual
+  std::cout << "Final trajectory: " << trajectory.getStepCount() << " steps, posDiff: " << sqrt(pow(cConstants->r_fin_ast - yOut.r, 2) + pow(cConstants->r_fin_ast * cConstants->theta_fin_ast - yOut.r * fmod(yOut.theta, 2 * M_PI), 2) + pow(cConstants->z_fin_ast - yOut.z, 2));
+  std::cout << " velDiff: " << sqrt(pow(cConstants->vr_fin_ast - yOut.vr, 2) + pow(cConstants->vtheta_fin_ast - yOut.vtheta, 2) + pow(cConstants->vz_fin_ast - yOut.vz, 2)) << std::endl;
+
   // calculate the error in conservation of mechanical energy due to the thruster
   errorCheck(times, yp, gamma, tau, lastStepInt, accel_output, fuelSpent, wetMass, work, dE, Etot_avg, cConstants);
 
@@ -375,6 +394,44 @@ void initializeRecord(const cudaConstants * cConstants) {
 
   excelFile << ",\n";
   excelFile.close();
+
+  // Header for the CPU backend's load balance file
+  if (cConstants->rk_backend == cudaConstants::CPU_BACKEND) {
+    std::ofstream balanceFile;
+    balanceFile.open("loadBalance-" + fileId + ".csv", std::ios_base::app);
+    balanceFile << "gen,threads,individuals,chunks,steals,minBusyTime,meanBusyTime,maxBusyTime,imbalance,calcPerS,tableFallbacks\n";
+    balanceFile.close();
+  }
+
+  // Header for the fitness cache counts
+  if (cConstants->fitness_cache_size > 0) {
+    std::ofstream cacheFile;
+    cacheFile.open("fitnessCache-" + fileId + ".csv", std::ios_base::app);
+    cacheFile << "gen,lookups,hits,repeats,evaluated,hitRate\n";
+    cacheFile.close();
+  }
+
+  // Header for the fitness screen counts
+  if (cConstants->screen_max_numsteps > 0) {
+    std::ofstream screenFile;
+    screenFile.open("screening-" + fileId + ".csv", std::ios_base::app);
+    screenFile << "gen,screened,refined,selectionChanges,rankChanges,maxPosDiffError,maxVelDiffError\n";
+    screenFile.close();
+  }
+
+  // Header for the pruning counts
+  if (cConstants->prune_checkpoints > 0) {
+    std::ofstream pruneFile;
+    pruneFile.open("pruning-" + fileId + ".csv", std::ios_base::app);
+    pruneFile << "gen,evaluated,pruned,workSaved,posCutoff,velCutoff\n";
+    pruneFile.close();
+  }
+
+  // Header for the heap allocations made each generation
+  std::ofstream allocFile;
+  allocFile.open("allocations-" + fileId + ".csv", std::ios_base::app);
+  allocFile << "gen,heapAllocations,scratchBytes\n";
+  allocFile.close();
 }
 
 // Take in the current state of the generation and appends to excel file, assumes initializeRecord() had already been called before (no need to output a header row)
@@ -407,6 +464,70 @@ void recordGenerationPerformance(const cudaConstants * cConstants, Individual *
   excelFile.close();
 }
 
+// Appends the load balance of the last CPU backend generation to loadBalance-[time_seed].csv, assumes initializeRecord() had already been called before
+void recordLoadBalance(const cudaConstants * cConstants, double generation, const loadBalanceSummary & summary, double calcPerS) {
+  std::ofstream balanceFile;
+  int seed = cConstants->time_seed;
+  balanceFile.open("loadBalance-" + std::to_string(seed) + ".csv", std::ios_base::app);
+
+  balanceFile << generation << "," << summary.threads << "," << summary.items << "," << summary.chunks << "," << summary.steals << ",";
+  balanceFile << summary.minBusyTime << "," << summary.meanBusyTime << "," << summary.maxBusyTime << ",";
+  balanceFile << summary.imbalance << "," << calcPerS << "," << summary.tableFallbacks << "\n";
+
+  balanceFile.close();
+}
+
+// Appends the fitness cache counts of a generation to fitnessCache-[time_seed].csv, assumes initializeRecord() had already been called before
+void recordFitnessCache(const cudaConstants * cConstants, double generation, const fitnessCacheStats & stats) {
+  std::ofstream cacheFile;
+  int seed = cConstants->time_seed;
+  cacheFile.open("fitnessCache-" + std::to_string(seed) + ".csv", std::ios_base::app);
+
+  // Share of the new individuals that did not need to be integrated
+  double hitRate = 0;
+  if (stats.lookups > 0) {
+    hitRate = static_cast<double>(stats.lookups - stats.evaluated) / stats.lookups;
+  }
+  cacheFile << generation << "," << stats.lookups << "," << stats.hits << "," << stats.repeats << "," << stats.evaluated << "," << hitRate << "\n";
+
+  cacheFile.close();
+}
+
+// Appends the fitness screen counts of a generation to screening-[time_seed].csv, assumes initializeRecord() had already been called before
+void recordScreening(const cudaConstants * cConstants, double generation, const screenStats & stats) {
+  std::ofstream screenFile;
+  int seed = cConstants->time_seed;
+  screenFile.open("screening-" + std::to_string(seed) + ".csv", std::ios_base::app);
+
+  screenFile << generation << "," << stats.screened << "," << stats.refined << "," << stats.selectionChanges << ",";
+  screenFile << stats.rankChanges << "," << stats.maxPosDiffError << "," << stats.maxVelDiffError << "\n";
+
+  screenFile.close();
+}
+
+// Appends the pruning counts of a generation to pruning-[time_seed].csv, assumes initializeRecord() had already been called before
+void recordPruning(const cudaConstants * cConstants, double generation, const pruneStats & stats) {
+  std::ofstream pruneFile;
+  int seed = cConstants->time_seed;
+  pruneFile.open("pruning-" + std::to_string(seed) + ".csv", std::ios_base::app);
+
+  pruneFile << generation << "," << stats.evaluated << "," << stats.pruned << "," << stats.workSaved << ",";
+  pruneFile << stats.posCutoff << "," << stats.velCutoff << "\n";
+
+  pruneFile.close();
+}
+
+// Appends the heap allocations made by a generation to allocations-[time_seed].csv, assumes initializeRecord() had already been called before
+void recordAllocations(const cudaConstants * cConstants, double generation, uint64_t allocations, size_t scratchBytes) {
+  std::ofstream allocFile;
+  int seed = cConstants->time_seed;
+  allocFile.open("allocations-" + std::to_string(seed) + ".csv", std::ios_base::app);
+
+  allocFile << generation << "," << allocations << "," << scratchBytes << "\n";
+
+  allocFile.close();
+}
+
 // Takes in a pool and records the parameter info on all individuals, currently unused
 // input: cConstants - to access time_seed in deriving file name
 //        pool - holds all the individuals to be stored
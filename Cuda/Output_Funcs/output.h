@@ -2,6 +2,12 @@
 #define OUTPUT_H
 
 #include <fstream>
+#include <cstdint> // for uint64_t
+#include "../Host_Threads/workStealing.h" // for loadBalanceSummary
+#include "../Genetic_Algorithm/fitnessCache.h" // for fitnessCacheStats
+#include "../Genetic_Algorithm/fitnessScreen.h" // for screenStats
+#include "../Runge_Kutta/pruning.h" // for pruneStats
+#include "../Runge_Kutta/denseTrajectory.h" // for DenseTrajectory, sampled by trajectoryPrint()
 
 // Utility function to display the currently best individual onto the terminal while the algorithm is still running
 // input: Individual to be displayed (assumed to be the best individual of the pool) 
@@ -31,7 +37,8 @@ void errorCheck(double *time, elements<double> *yp,  double *gamma,  double *tau
 //        generation - generation num of individual        
 //        cConstants - Access constants info such as target element, earth element, derive spaceCraft element, also other values such as rk_tol
 //        best - To access the best individual (pool[0])
-// output: file orbitalMotion-[time_seed].bin is created that holds spacecraft RK steps and error
+// output: file orbitalMotion-[time_seed].bin is created that holds the spacecraft's trajectory and error at cpu_numsteps even
+//         intervals of the trip, sampled from a DenseTrajectory integrated once with adaptive steps
 //         file finalOptimization-[time_seed].bin is created that holds earth/ast/ and trajectory parameter values
 void trajectoryPrint(double x[], int generation, const cudaConstants* cConstants, Individual best);
 
@@ -48,6 +55,11 @@ void progressiveAnalysis(int generation, int numStep, double *start, elements<do
 // Initialize some of the files used in record mode with header rows
 // input: cConstants - to access time_seed for deriving file name conventions
 // output: files genPerformanceT-[time_seed].csv is given initial header row info for generation, best posDiff, best velDiff, and parameters of best individual
+//         if the CPU backend is used, loadBalance-[time_seed].csv is also given a header row
+//         allocations-[time_seed].csv is given a header row
+//         if fitness_cache_size is set, fitnessCache-[time_seed].csv is given a header row
+//         if screen_max_numsteps is set, screening-[time_seed].csv is given a header row
+//         if prune_checkpoints is set, pruning-[time_seed].csv is given a header row
 void initializeRecord(const cudaConstants * cConstants);
 
 // Take in the current state of the generation and appends to files
@@ -60,6 +72,51 @@ void initializeRecord(const cudaConstants * cConstants);
 // output: genPerformanceT-[time_seed].csv is appended parameter information on the best individual in pool
 void recordGenerationPerformance(const cudaConstants * cConstants, Individual * pool, double generation, double new_anneal, int poolSize);
 
+// Take in the load balance of the CPU backend for the last generation evaluated and append to file
+// assumes initializeRecord() had already been called before (therefore no need to output a header row)
+// input: cConstants - access time_seed to derive file name
+//        generation - record current generation
+//        summary - load balance of the last callRKCPU(), from rkScheduler->getSummary()
+//        calcPerS - individuals evaluated per second in the last callRKCPU()
+// output: loadBalance-[time_seed].csv is appended a row with thread, chunk, steal, and busy time information, and the number of
+//         individuals whose thrust table could not meet thrust_table_tol
+void recordLoadBalance(const cudaConstants * cConstants, double generation, const loadBalanceSummary & summary, double calcPerS);
+
+// Append the fitness cache's counts for a generation to file
+// assumes initializeRecord() had already been called before (therefore no need to output a header row)
+// input: cConstants - access time_seed to derive file name
+//        generation - record current generation
+//        stats - counts of the generation's lookup, from FitnessCache::getStats()
+// output: fitnessCache-[time_seed].csv is appended a row with the lookups, hits, repeats, individuals evaluated, and hit rate
+void recordFitnessCache(const cudaConstants * cConstants, double generation, const fitnessCacheStats & stats);
+
+// Append the fitness screen's counts for a generation to file
+// assumes initializeRecord() had already been called before (therefore no need to output a header row)
+// input: cConstants - access time_seed to derive file name
+//        generation - record current generation
+//        stats - counts of the generation's screening, from FitnessScreen::getStats()
+// output: screening-[time_seed].csv is appended a row with the individuals screened and refined, how many changed sides
+//         of the survivor boundaries or places by posDiff once refined, and the largest posDiff and velDiff errors of the coarse pass
+void recordScreening(const cudaConstants * cConstants, double generation, const screenStats & stats);
+
+// Append the pruning counts for a generation to file
+// assumes initializeRecord() had already been called before (therefore no need to output a header row)
+// input: cConstants - access time_seed to derive file name
+//        generation - record current generation
+//        stats - counts of the generation's evaluated individuals, from countPruned()
+// output: pruning-[time_seed].csv is appended a row with the individuals evaluated and pruned, the share of their trip time
+//         that was not integrated, and the cutoffs they were pruned against
+void recordPruning(const cudaConstants * cConstants, double generation, const pruneStats & stats);
+
+// Append the heap allocations made by a generation to file
+// assumes initializeRecord() had already been called before (therefore no need to output a header row)
+// input: cConstants - access time_seed to derive file name
+//        generation - record current generation
+//        allocations - heap allocations made by the generation (evaluation, selection, and making the next generation), from heapAllocations()
+//        scratchBytes - size of the GenerationEngine's scratch arenas after the generation
+// output: allocations-[time_seed].csv is appended a row, allocations should be 0 once scratchBytes stops growing
+void recordAllocations(const cudaConstants * cConstants, double generation, uint64_t allocations, size_t scratchBytes);
+
 // Method for doing recording information at the end of the optimization process
 // input: cConstants - to access config info
 //        pool - To access the best individual (pool[0])
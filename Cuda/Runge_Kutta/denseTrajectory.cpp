@@ -0,0 +1,161 @@
+#include <math.h> // for fmin and fmax
+
+DenseTrajectory::DenseTrajectory(const elements<double> & y0, const double & timeInitial, const double & tripTime, coefficients<double> & coeff, const double & startStepSize, const cudaConstants* cConstants)
+    : stepCount(0), capacity(cConstants->max_numsteps + 1), startTime(timeInitial), endTime(tripTime) {
+    steps = new denseStep[capacity];
+
+    thruster<double> thrust(cConstants);
+    bool controlled = (cConstants->step_control == cudaConstants::PI_STEP);
+
+    // Same limits on the step size as rk4SimpleIndividual()
+    const double minStep = (tripTime - timeInitial) / cConstants->max_numsteps;
+    const double maxStep = (tripTime - timeInitial) / cConstants->min_numsteps;
+    double stepSize = controlled ? fmin(fmax(startStepSize, minStep), maxStep) : startStepSize;
+
+    // State of the PI controller for step_control=PI, as in rk4ControlledIndividual()
+    double errPrev = 1e-4;
+    bool rejected = false;
+    const int errorOrder = dormandPrince5Tableau::errorOrder;
+
+    double curTime = timeInitial;
+    double massFuelSpent = 0;
+    elements<double> curPos = y0, nextPos, error;
+    stageCache<double> cache; // carries the last stage of each accepted step to the first of the next
+    denseStep step;
+
+    while (curTime < tripTime) {
+        if (controlled && (curTime + stepSize) > tripTime) {
+            stepSize = (tripTime - curTime); // shorten the last step to end exactly at time final
+        }
+        double plannedStep = stepSize;
+
+        step.time = curTime;
+        step.y = curPos;
+        step.fuelStart = step.fuelEnd = massFuelSpent;
+        if (cConstants->thruster_type == thruster<double>::NO_THRUST) {
+            step.accel = 0;
+        }
+        else {
+            // With step_control=PI the step ends where the thrust switches, if it does during the step
+            bool coast = calc_coast(coeff, curTime, tripTime, thrust);
+            if (controlled && calc_coast(coeff, curTime + stepSize, tripTime, thrust) != coast) {
+                stepSize = coastSwitchTime(coeff, curTime, curTime + stepSize, tripTime, thrust, coast) - curTime;
+            }
+            step.accel = calc_accel(curPos.r, curPos.z, thrust, step.fuelEnd, stepSize, coast, static_cast<double>(cConstants->wet_mass), cConstants);
+        }
+        step.stepSize = stepSize;
+
+        // calculate k values and get the value at the end of the step, keeping the k values for the dense output
+        nextPos = curPos;
+        rkCalc(curTime, tripTime, stepSize, nextPos, coeff, step.accel, error, cudaConstants::DP5_TABLEAU, &cache, step.k);
+
+        double nextStep;
+        if (controlled) {
+            double errNorm = calc_errorNorm(curPos, nextPos, error, cConstants->rk_tol);
+            nextStep = calc_piStep(stepSize, errNorm, errPrev, rejected, errorOrder);
+
+            // Over the tolerance, try again from the same place with a smaller step
+            if (errNorm > 1 && stepSize > minStep) {
+                stepSize = fmax(nextStep, minStep);
+                continue;
+            }
+
+            // A step that was cut short at a thrust switch does not make the next one smaller
+            if (stepSize < plannedStep) {
+                nextStep = fmax(nextStep, plannedStep);
+            }
+            nextStep = fmin(fmax(nextStep, minStep), maxStep);
+        }
+        else {
+            nextStep = stepSize * calc_scalingFactor(nextPos-error, error, cConstants->rk_tol, cConstants->doublePrecThresh);
+            if (nextStep > maxStep) {
+                nextStep = maxStep;
+            }
+            else if (nextStep < minStep) {
+                nextStep = minStep;
+            }
+        }
+
+        addStep(step);
+        curPos = nextPos;
+        curTime += stepSize;
+        massFuelSpent = step.fuelEnd;
+        stepSize = nextStep;
+
+        if (!controlled && (curTime + stepSize) > tripTime) {
+            stepSize = (tripTime - curTime); // shorten the last step to end exactly at time final
+        }
+    }
+
+    endY = curPos;
+    endFuel = massFuelSpent;
+}
+
+void DenseTrajectory::addStep(const denseStep & step) {
+    if (stepCount == capacity) {
+        denseStep *larger = new denseStep[2*capacity];
+        for (int i = 0; i < stepCount; i++) {
+            larger[i] = steps[i];
+        }
+        delete [] steps;
+        steps = larger;
+        capacity *= 2;
+    }
+    steps[stepCount] = step;
+    stepCount++;
+}
+
+int DenseTrajectory::findStep(const double & time) const {
+    // Last step starting at or before time
+    int low = 0, high = stepCount - 1;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (steps[mid].time <= time) {
+            low = mid;
+        }
+        else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+int DenseTrajectory::getStepCount() const {
+    return stepCount;
+}
+
+elements<double> DenseTrajectory::getCondition(const double & time) const {
+    if (stepCount == 0 || time >= endTime) {
+        return endY;
+    }
+    if (time <= startTime) {
+        return steps[0].y;
+    }
+    const denseStep & step = steps[findStep(time)];
+    if (time == step.time) {
+        return step.y;
+    }
+    return rkDenseOutput(step.y, step.k, (time - step.time) / step.stepSize);
+}
+
+double DenseTrajectory::getAccel(const double & time) const {
+    if (stepCount == 0) {
+        return 0;
+    }
+    return steps[findStep(time)].accel;
+}
+
+double DenseTrajectory::getFuelSpent(const double & time) const {
+    if (stepCount == 0 || time >= endTime) {
+        return endFuel;
+    }
+    if (time <= startTime) {
+        return 0;
+    }
+    const denseStep & step = steps[findStep(time)];
+    return step.fuelStart + (step.fuelEnd - step.fuelStart) * (time - step.time) / step.stepSize;
+}
+
+DenseTrajectory::~DenseTrajectory() {
+    delete [] steps;
+}
@@ -0,0 +1,66 @@
+#ifndef DENSETRAJECTORY_H
+#define DENSETRAJECTORY_H
+
+#include "runge_kutta.h" // for rkCalc(), rkDenseOutput(), and the step size controls
+
+// One accepted step of a DenseTrajectory
+struct denseStep {
+    double time;         // time at the start of the step (s)
+    double stepSize;     // length of the step (s)
+    elements<double> y;  // position and velocity at the start of the step
+    elements<double> k[dormandPrince5Tableau::stages]; // stages of the step from rkCalc() (include the step size), for rkDenseOutput()
+    double accel;        // thrust acceleration held through the step (au/s^2)
+    double fuelStart;    // fuel spent by the start of the step (kg)
+    double fuelEnd;      // fuel spent by the end of the step (kg)
+};
+
+// Spacecraft trajectory that can be sampled at any time, used to record the final result of a run in trajectoryPrint()
+// Integrated once with the step size control individuals are evaluated with (step_control, rk_tol, min_numsteps, max_numsteps),
+// keeping the stages of every accepted step, so a time is found from the continuous extension (rkDenseOutput()) of the step it
+// is in instead of stepping again at a fixed step size to land on it
+// Always Dormand-Prince 5(4) as rkDenseOutput() is its interpolant, stepping through coast arcs (not kepler_coast) with the
+// thrust angles from the Fourier series, so it can differ from the individual's evaluation by the Runge-Kutta error
+// Steps are kept in an array with room for max_numsteps of them, which doubles if steps shortened at thrust switches fill it
+class DenseTrajectory {
+    private:
+        denseStep *steps;
+        int stepCount;  // steps kept
+        int capacity;   // room in steps
+        double startTime, endTime; // (s)
+        elements<double> endY;     // value at endTime, the result of the last step
+        double endFuel;            // fuel spent by endTime (kg)
+
+        // Keeps an accepted step, doubling the room for steps if it is full
+        void addStep(const denseStep & step);
+
+        // Index of the step time is in, a time on the boundary of two steps is in the later one
+        int findStep(const double & time) const;
+
+    public:
+        // Integrates the spacecraft from launch to the end of its trip
+        // Input: y0 - position and velocity at launch
+        //        timeInitial, tripTime - start and end of the trajectory (s)
+        //        coeff - thrust profile of the individual
+        //        startStepSize - first step size to try (s), as for rk4SimpleIndividual()
+        //        cConstants - step_control, rk_tol, doublePrecThresh, min_numsteps, max_numsteps, and the thruster
+        DenseTrajectory(const elements<double> & y0, const double & timeInitial, const double & tripTime, coefficients<double> & coeff, const double & startStepSize, const cudaConstants* cConstants);
+
+        // Number of steps the integration took
+        int getStepCount() const;
+
+        // Position and velocity at time (s), from the dense output of the step it is in
+        // Times outside of the trajectory are clamped to its start or end, the end is the integration's result exactly
+        elements<double> getCondition(const double & time) const;
+
+        // Thrust acceleration at time (au/s^2), held through each step as in the integration
+        double getAccel(const double & time) const;
+
+        // Fuel spent by time (kg), linear through each step
+        double getFuelSpent(const double & time) const;
+
+        // Frees the steps
+        ~DenseTrajectory();
+};
+
+#include "denseTrajectory.cpp"
+#endif
@@ -0,0 +1,250 @@
+#include <math.h>   // for fmin, fmax, and fabs
+#include <chrono>   // for timing the verification
+#include <iostream> // cout
+#include <algorithm> // for std::max and std::min, the number of slices
+
+int pararealPropagate(pararealState & state, double curTime, const double & endTime, const double & tripTime, coefficients<double> & coeff, const double & absTol, const int & tableau, const double & minStep, const double & maxStep, double & stepSize, const cudaConstants* cConstants, pararealGrid & grid) {
+    thruster<double> thrust(cConstants);
+    elements<double> nextPos, error;
+    stageCache<double> cache; // carries the last stage of each accepted step to the first of the next
+
+    // State of the PI controller, as in rk4ControlledIndividual()
+    double errPrev = 1e-4;
+    bool rejected = false;
+    const int errorOrder = tableauErrorOrder(tableau);
+
+    // Take the steps from the last time the slice was integrated if there were any
+    const bool replay = (grid.count > 0);
+    int steps = 0;
+
+    double curAccel = 0;
+    double stepFuelSpent; // fuel spent if the step is accepted
+    stepSize = fmin(fmax(stepSize, minStep), maxStep);
+
+    while (curTime < endTime) {
+        // Step size the control chose, kept for the next step if this one is shortened
+        double plannedStep = stepSize;
+        if (replay) {
+            stepSize = grid.stepEnd[steps] - curTime;
+        }
+        else if (curTime + stepSize > endTime) {
+            stepSize = endTime - curTime; // shorten the last step to end exactly at endTime
+        }
+
+        stepFuelSpent = state.fuelSpent;
+        if (cConstants->thruster_type != thruster<double>::NO_THRUST) {
+            // End the step where the thrust switches, if it does during the step (a replayed step already does)
+            bool coast = calc_coast(coeff, curTime, tripTime, thrust);
+            if (!replay && calc_coast(coeff, curTime + stepSize, tripTime, thrust) != coast) {
+                stepSize = coastSwitchTime(coeff, curTime, curTime + stepSize, tripTime, thrust, coast) - curTime;
+            }
+            curAccel = calc_accel(state.y.r, state.y.z, thrust, stepFuelSpent, stepSize, coast, static_cast<double>(cConstants->wet_mass), cConstants);
+        }
+
+        nextPos = state.y;
+        rkCalc(curTime, tripTime, stepSize, nextPos, coeff, curAccel, error, tableau, &cache);
+
+        double newStep = stepSize;
+        if (!replay) {
+            double errNorm = calc_errorNorm(state.y, nextPos, error, absTol);
+            newStep = calc_piStep(stepSize, errNorm, errPrev, rejected, errorOrder);
+
+            // Over the tolerance, try again from the same place with a smaller step
+            if (errNorm > 1 && stepSize > minStep) {
+                stepSize = fmax(newStep, minStep);
+                continue;
+            }
+        }
+
+        state.y = nextPos;
+        state.fuelSpent = stepFuelSpent;
+        curTime += stepSize;
+
+        if (replay) {
+            // Land on the step's end exactly, as it was recorded
+            curTime = grid.stepEnd[steps];
+        }
+        else {
+            // Keep the step, doubling the room for steps if it is full
+            if (grid.count == grid.capacity) {
+                double *larger = new double[2*grid.capacity];
+                for (int i = 0; i < grid.count; i++) {
+                    larger[i] = grid.stepEnd[i];
+                }
+                delete [] grid.stepEnd;
+                grid.stepEnd = larger;
+                grid.capacity *= 2;
+            }
+            grid.stepEnd[grid.count] = curTime;
+            grid.count++;
+
+            // A step that was cut short (at a thrust switch or endTime) does not make the next one smaller
+            if (stepSize < plannedStep) {
+                newStep = fmax(newStep, plannedStep);
+            }
+            stepSize = fmin(fmax(newStep, minStep), maxStep);
+        }
+        steps++;
+    }
+    return steps;
+}
+
+void pararealWorker(int threadId, int numThreads, void* context) {
+    pararealJob *job = static_cast<pararealJob*>(context);
+    const cudaConstants *cConstants = job->cConstants;
+
+    for (int n = job->firstSlice + threadId; n < job->slices; n += numThreads) {
+        // Steps no longer than verify_numsteps over the trip allows, as the thrust held through each step is only as accurate as
+        // the step is short, and no shorter than that by more than the evaluations' max_numsteps/min_numsteps range
+        double maxStep = job->tripTime / cConstants->verify_numsteps;
+        double minStep = maxStep * cConstants->min_numsteps / cConstants->max_numsteps;
+        double stepSize = maxStep;
+
+        job->fine[n] = job->start[n];
+        job->fineSteps[n] = pararealPropagate(job->fine[n], job->sliceTime[n], job->sliceTime[n+1], job->tripTime, *job->coeff, cConstants->verify_tol, cudaConstants::DOP853_TABLEAU, minStep, maxStep, stepSize, cConstants, job->fineGrid[n]);
+    }
+}
+
+pararealResult pararealIntegrate(const rkParameters<double> & start, const cudaConstants* cConstants) {
+    pararealResult result;
+    const double tripTime = start.tripTime;
+    coefficients<double> coeff = start.coeff;
+
+    // Use a pool of cpu_threads made for this if there is no cpuPool (ThreadPool makes one per core for 0, and never fewer than 1)
+    ThreadPool *pool = cpuPool;
+    if (pool == nullptr) {
+        pool = new ThreadPool(cConstants->cpu_threads);
+    }
+    // At least one slice, the whole trip
+    int slices = std::max(1, (cConstants->parareal_slices > 0) ? cConstants->parareal_slices : pool->size());
+    // Too few to take fewer iterations than slices, so parareal would only add the coarse passes to a serial fine integration
+    if (std::min(slices, pool->size()) <= PARAREAL_SERIAL_SLICES) {
+        slices = 1;
+    }
+
+    // Even slices of the trip
+    double *sliceTime = new double[slices+1];
+    for (int n = 0; n < slices; n++) {
+        sliceTime[n] = tripTime * n / slices;
+    }
+    sliceTime[slices] = tripTime;
+
+    pararealState *starts = new pararealState[slices+1]; // starting conditions of each slice, starts[slices] is the end of the trip
+    pararealState *fine = new pararealState[slices];     // where each slice's fine propagator ended
+    pararealState *coarse = new pararealState[slices];   // where each slice's coarse propagator ended from the last iteration's start
+    int *fineSteps = new int[slices];
+
+    // Steps of each slice's propagators, chosen the first time they integrate it
+    pararealGrid *fineGrid = new pararealGrid[slices];
+    pararealGrid *coarseGrid = new pararealGrid[slices];
+    for (int n = 0; n < slices; n++) {
+        fineGrid[n].count = coarseGrid[n].count = 0;
+        fineGrid[n].capacity = coarseGrid[n].capacity = 64;
+        fineGrid[n].stepEnd = new double[fineGrid[n].capacity];
+        coarseGrid[n].stepEnd = new double[coarseGrid[n].capacity];
+    }
+
+    // The coarse propagator takes steps of up to a slice, no shorter than the evaluations' smallest step
+    const double coarseMin = tripTime / cConstants->max_numsteps;
+    const double coarseMax = tripTime / slices;
+    double coarseStep = tripTime / cConstants->min_numsteps;
+
+    result.coarseSteps = 0;
+    result.fineSteps = 0;
+
+    // First guess of the slice starts, one coarse pass over the trip (not needed for one slice, its fine pass is exact)
+    starts[0].y = start.y0;
+    starts[0].fuelSpent = 0;
+    for (int n = 0; n < slices && slices > 1; n++) {
+        coarse[n] = starts[n];
+        result.coarseSteps += pararealPropagate(coarse[n], sliceTime[n], sliceTime[n+1], tripTime, coeff, cConstants->parareal_coarse_tol, cudaConstants::DP5_TABLEAU, coarseMin, coarseMax, coarseStep, cConstants, coarseGrid[n]);
+        starts[n+1] = coarse[n];
+    }
+
+    pararealJob job = {starts, fine, fineSteps, fineGrid, sliceTime, 0, slices, tripTime, &coeff, cConstants};
+    result.correction = 0;
+    result.iterations = 0;
+
+    // Stops once the slice starts change by less than verify_tol, or after the last slice's fine propagator (which makes them exact)
+    // Near verify_tol the change can stop shrinking at the rounding of the corrections (theta is summed to about 1e-15 rad),
+    // those keep iterating to the exact result so every result is verified
+    bool converged = false;
+    for (int k = 0; k < slices && !converged; k++) {
+        // Fine propagators of the slices that are not converged yet, at the same time
+        job.firstSlice = k;
+        pool->run(pararealWorker, &job);
+        for (int n = k; n < slices; n++) {
+            result.fineSteps += fineSteps[n];
+        }
+        result.iterations++;
+
+        // Slice k started from a converged start, so its fine result is exact and the correction starts after it
+        starts[k+1] = fine[k];
+        result.correction = 0;
+        for (int n = k+1; n < slices; n++) {
+            pararealState next = starts[n];
+            result.coarseSteps += pararealPropagate(next, sliceTime[n], sliceTime[n+1], tripTime, coeff, cConstants->parareal_coarse_tol, cudaConstants::DP5_TABLEAU, coarseMin, coarseMax, coarseStep, cConstants, coarseGrid[n]);
+
+            pararealState corrected;
+            corrected.y = next.y + fine[n].y - coarse[n].y;
+            corrected.fuelSpent = next.fuelSpent + fine[n].fuelSpent - coarse[n].fuelSpent;
+            coarse[n] = next;
+
+            // Change in this slice's end, position and velocity as calc_errorNorm() measures a step's error, fuel against fuel_mass
+            double change = calc_errorNorm(starts[n+1].y, corrected.y, corrected.y - starts[n+1].y, cConstants->verify_tol);
+            change = fmax(change, fabs(corrected.fuelSpent - starts[n+1].fuelSpent) / (cConstants->verify_tol * cConstants->fuel_mass));
+            result.correction = fmax(result.correction, change);
+
+            starts[n+1] = corrected;
+        }
+        converged = (result.correction <= 1);
+    }
+
+    result.finalPos = starts[slices].y;
+    result.fuelSpent = starts[slices].fuelSpent;
+    result.slices = slices;
+
+    delete [] sliceTime;
+    delete [] starts;
+    delete [] fine;
+    delete [] coarse;
+    delete [] fineSteps;
+    for (int n = 0; n < slices; n++) {
+        delete [] fineGrid[n].stepEnd;
+        delete [] coarseGrid[n].stepEnd;
+    }
+    delete [] fineGrid;
+    delete [] coarseGrid;
+    if (pool != cpuPool) {
+        delete pool;
+    }
+    return result;
+}
+
+// Called by optimize() in optimization.cu
+void verifyFinalists(Individual *pool, const int & count, const cudaConstants* cConstants) {
+    std::cout << "\nVerifying the best " << count << " individuals to " << cConstants->verify_tol << " with parareal:" << std::endl;
+
+    for (int i = 0; i < count; i++) {
+        std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+        pararealResult result = pararealIntegrate(pool[i].startParams, cConstants);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        // posDiff and velDiff of the verified trajectory, without changing the individual
+        Individual verified = pool[i];
+        verified.finalPos = result.finalPos;
+        verified.getPosDiff(cConstants);
+        verified.getVelDiff(cConstants);
+
+        std::cout << "  #" << i << " posDiff: " << verified.posDiff << " (evaluated " << pool[i].posDiff << ")";
+        std::cout << " velDiff: " << verified.velDiff << " (evaluated " << pool[i].velDiff << ")";
+        std::cout << " fuel: " << result.fuelSpent << " kg" << std::endl;
+        std::cout << "     " << result.iterations << " iterations of " << result.slices << " slices (last correction " << result.correction << " times verify_tol";
+        if (result.iterations == result.slices) {
+            // Every slice's fine propagator started from an exact start on its last iteration
+            std::cout << ", the same as one serial fine integration";
+        }
+        std::cout << "), ";
+        std::cout << result.fineSteps << " fine and " << result.coarseSteps << " coarse steps, " << elapsed.count() << " s" << std::endl;
+    }
+}
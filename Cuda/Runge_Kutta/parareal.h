@@ -0,0 +1,101 @@
+#ifndef PARAREAL_H
+#define PARAREAL_H
+
+#include "../Host_Threads/threadPool.h" // for cpuPool, runs the fine propagators of the time slices at the same time
+#include "runge_kuttaCUDA.cuh"          // for Individual and the runge kutta steps
+
+// Parareal (parallel in time) integration of a spacecraft trajectory, used to verify the best individuals of a run at a much
+// tighter tolerance (verify_tol) than they were evaluated with, without one long serial integration for each
+// The trip is split into parareal_slices time slices. A coarse propagator (DP5 at parareal_coarse_tol) is run serially over
+// the whole trip to find each slice's starting conditions, then every slice is integrated by the fine propagator (DOP853 at
+// verify_tol, at least verify_numsteps steps over the trip) on its own thread of cpuPool. Each iteration corrects the slice starts with
+//     start[n+1] = coarse(start[n]) + fine(old start[n]) - coarse(old start[n])
+// and integrates the slices again, until the starts stop changing by more than verify_tol. After k iterations the first k
+// slices are the same as one serial fine integration, so it never takes more iterations than there are slices, and a trajectory
+// whose starts stop changing short of verify_tol (from rounding) iterates until it is exact
+// Both propagators choose their steps over a slice the first time they integrate it and take the same steps on later iterations
+// As the thrust acceleration is held through each step, the result depends on where the steps fall by more than verify_tol,
+// so steps chosen again from a slightly different start would keep the iterations from converging
+// Measured on random individuals with the defaults, the iterations take 5 to 7 at 8 slices, 5 to 11 at 16 and 6 to 13 at 32, so the fine
+// work on the critical path is at best 1.1 to 1.6, 1.5 to 3.2 and 2.5 to 5.3 times shorter than one serial fine integration (before the
+// serial coarse passes). With 4 slices or fewer it always takes as many iterations as there are slices and is slower than serial
+
+// Slices (or threads to run them on) at or below which pararealIntegrate() integrates the whole trip once with the fine propagator instead
+#define PARAREAL_SERIAL_SLICES 4
+
+// Position, velocity, and fuel spent at the start or end of a time slice, the state carried between slices
+struct pararealState {
+    elements<double> y; // position and velocity
+    double fuelSpent;   // fuel spent since launch (kg), changes the thrust acceleration
+};
+
+// Result of pararealIntegrate()
+struct pararealResult {
+    elements<double> finalPos; // position and velocity at the end of the trip
+    double fuelSpent;          // fuel spent over the trip (kg)
+    int slices;                // time slices the trip was split into
+    int iterations;            // times the fine propagators were run
+    double correction;         // largest change in the slice starts on the last iteration, in units of verify_tol (calc_errorNorm())
+    int fineSteps;             // fine steps accepted over all iterations
+    int coarseSteps;           // coarse steps accepted over all iterations
+};
+
+// Steps a propagator took over one time slice, kept so later iterations take the same steps
+struct pararealGrid {
+    double *stepEnd; // time each step ended at (s)
+    int count;       // steps kept, 0 until the slice is first integrated
+    int capacity;    // room in stepEnd, doubled when it is full
+};
+
+// Integrates the spacecraft from curTime to endTime with the PI step size control of rk4ControlledIndividual() (steps over
+// absTol are retried, steps end where the thrust switches), without kepler_coast, pruning, or the check for getting close to the sun
+// If grid already holds steps they are taken again in place of the step size control
+// Used as both the coarse and the fine propagator of pararealIntegrate()
+// Input: state - conditions at curTime
+//        curTime, endTime - start and end of the integration (s)
+//        tripTime - end of the trip, what the thrust profile is over (s)
+//        coeff - thrust profile of the individual
+//        absTol - tolerance of calc_errorNorm() for each step
+//        tableau - cudaConstants::RK_TABLEAU pair to step with
+//        minStep, maxStep - limits on the step size (s), a step at minStep is kept even if it is over absTol
+//        stepSize - first step size to try (s)
+//        cConstants - thruster information
+//        grid - steps to take, or empty to choose them
+// Output: state is the conditions at endTime, stepSize is the step size the control would take next
+//         grid holds the steps taken, returns the number of steps accepted
+int pararealPropagate(pararealState & state, double curTime, const double & endTime, const double & tripTime, coefficients<double> & coeff, const double & absTol, const int & tableau, const double & minStep, const double & maxStep, double & stepSize, const cudaConstants* cConstants, pararealGrid & grid);
+
+// Everything the threads need to run the fine propagators of one parareal iteration, passed through ThreadPool::run()
+struct pararealJob {
+    const pararealState *start; // starting conditions of each slice
+    pararealState *fine;        // conditions each slice's fine propagator ends at
+    int *fineSteps;             // steps each slice's fine propagator took
+    pararealGrid *fineGrid;     // steps of each slice's fine propagator
+    const double *sliceTime;    // start time of each slice, sliceTime[slices] is the tripTime
+    int firstSlice;             // slices before this are already converged and are not integrated again
+    int slices;
+    double tripTime;
+    coefficients<double> *coeff;
+    const cudaConstants *cConstants;
+};
+
+// ThreadPool task for pararealIntegrate(), each thread integrates every numThreads'th slice from firstSlice + threadId
+void pararealWorker(int threadId, int numThreads, void* context);
+
+// Integrates the trajectory of an individual to verify_tol with parareal, on the threads of cpuPool (or a pool of cpu_threads made for it)
+// When there are no more than PARAREAL_SERIAL_SLICES slices or threads, the trip is one slice integrated by the fine propagator on this thread
+// Input: start - the individual's starting conditions, thrust profile, and trip time
+//        cConstants - verify_tol, verify_numsteps, parareal_slices (0 for one per thread), parareal_coarse_tol, the step limits, and the thruster
+// Output: the conditions at the end of the trip, and how the iterations went
+pararealResult pararealIntegrate(const rkParameters<double> & start, const cudaConstants* cConstants);
+
+// Verifies the best individuals at the end of a run, displaying their posDiff and velDiff found with pararealIntegrate()
+// next to the ones they were evaluated with
+// Input: pool - the individuals in order of cost, the first count are verified
+//        count - number of individuals to verify
+//        cConstants - passed to pararealIntegrate()
+// Called by optimize() in optimization.cu when verify_count is above 0
+void verifyFinalists(Individual *pool, const int & count, const cudaConstants* cConstants);
+
+#include "parareal.cpp"
+#endif
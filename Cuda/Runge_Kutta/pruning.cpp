@@ -0,0 +1,133 @@
+#include <math.h> // sqrt, log, asin, atan2, fmin, fmax
+
+void initPruneThruster(pruneBounds & bounds, const cudaConstants* cConstants) {
+    bounds.maxAccel = 0;
+    bounds.exhaustVel = 0;
+    if (cConstants->thruster_type == thruster<double>::NO_THRUST) {
+        return;
+    }
+
+    // Thrust and thrust per fuel flow as calc_accel() finds them, at input powers up to P0
+    thruster<double> thrust(cConstants);
+    const int samples = 1000;
+    double maxThrust = 0;
+    for (int i = 1; i <= samples; i++) {
+        double Pin = thrust.P0 * i / samples;
+        double mDot = thrust.calc_m_Dot(Pin);
+        if (mDot > 0) {
+            double force = sqrt(2 * thrust.calc_eff(Pin) * Pin * mDot);
+            maxThrust = fmax(maxThrust, force);
+            bounds.exhaustVel = fmax(bounds.exhaustVel, force / mDot);
+        }
+    }
+    // AU converts from m/s^2 and m/s, as in calc_accel()
+    bounds.maxAccel = maxThrust / (AU * (cConstants->wet_mass - cConstants->fuel_mass));
+    bounds.exhaustVel /= AU;
+}
+
+__host__ __device__ void reachableDiffs(const elements<double> & y, const double & timeLeft, const double & massExpelled, const pruneBounds & bounds, const cudaConstants* cConstants, double & posLower, double & velUpper) {
+    posLower = 0;
+    velUpper = INFINITY;
+    if (y.theta < 0) {
+        return;
+    }
+    const double mu = constG * massSun;
+
+    // Where the coast arc ends
+    cartesianState<double> now = cylindricalToCartesian(y);
+    cartesianState<double> end = keplerPropagate(now, timeLeft, mu);
+
+    // Delta-v left in the fuel, the rocket equation with the thruster's best exhaust velocity
+    double massNow = cConstants->wet_mass - massExpelled;
+    double massDry = cConstants->wet_mass - cConstants->fuel_mass;
+    double deltaV = (massNow > massDry) ? bounds.exhaustVel * log(massNow / massDry) : 0;
+
+    // How far thrust can move the final position (dist) and velocity (distVel) from the coast arc's, from the linearized
+    // (Clohessy-Wiltshire) response to an impulse dv after tau = n t in the orbit's mean motion n: in any direction the position
+    // moves at most dv/n min(tau + tau^2, 3 tau + 4.5) and the velocity at most dv min(1 + 2.2 tau, 7)
+    // Thrusting the whole time adds these up over the time left, all of the delta-v at the start is the most the fuel allows
+    double dist = 0, distVel = 0;
+    if (deltaV > 0) {
+        double radius = sqrt(y.r*y.r + y.z*y.z);
+        double v2 = now.vel[0]*now.vel[0] + now.vel[1]*now.vel[1] + now.vel[2]*now.vel[2];
+        double energy = v2/2 - mu/radius;
+        // Semi-major axis, the current radius for an escape orbit
+        double axis = (energy < 0) ? -mu/(2*energy) : radius;
+        double n = sqrt(mu/(axis*axis*axis));
+        double tau = n*timeLeft;
+
+        // Integrals over [0, tau] of the position and velocity responses, each is linear past its knee
+        const double posKnee = 1 + sqrt(5.5), velKnee = 6/2.2;
+        double posTau = fmin(tau, posKnee), velTau = fmin(tau, velKnee);
+        double posInt = posTau*posTau/2 + posTau*posTau*posTau/3 + 1.5*(tau*tau - posTau*posTau) + 4.5*(tau - posTau);
+        double velInt = velTau + 1.1*velTau*velTau + 7*(tau - velTau);
+
+        dist = fmin(bounds.maxAccel/(n*n)*posInt, deltaV/n*fmin(tau + tau*tau, 3*tau + 4.5));
+        distVel = fmin(bounds.maxAccel/n*velInt, deltaV*fmin(1 + 2.2*tau, 7.0));
+    }
+
+    // Final position of the arc in cylindrical coordinates, theta in [0, 2 pi) as fmod() gives in calcPosDiff()
+    double rho = sqrt(end.pos[0]*end.pos[0] + end.pos[1]*end.pos[1]);
+    double phi = atan2(end.pos[1], end.pos[0]);
+    if (phi < 0) {
+        phi += 2*M_PI;
+    }
+    double z = end.pos[2];
+
+    // Largest change in the angle from moving the position by dist
+    double dPhi = (dist < rho) ? asin(dist/rho) : M_PI;
+
+    // posDiff's radial and z terms change by at most dist, the r*theta term lies between the products of the ranges of r and theta
+    double dr = fmax(0.0, fabs(cConstants->r_fin_ast - rho) - dist);
+    double dz = fmax(0.0, fabs(cConstants->z_fin_ast - z) - dist);
+    double rLo = fmax(0.0, rho - dist), rHi = rho + dist;
+    double thetaLo = phi - dPhi, thetaHi = phi + dPhi;
+    if (thetaLo < 0 || thetaHi >= 2*M_PI) {
+        // fmod() wraps inside the range
+        thetaLo = 0;
+        thetaHi = 2*M_PI;
+    }
+    double arc = cConstants->r_fin_ast * cConstants->theta_fin_ast;
+    double dArc = fmax(0.0, fmax(rLo*thetaLo - arc, arc - rHi*thetaHi));
+    posLower = sqrt(dr*dr + dz*dz + dArc*dArc);
+
+    // velDiff of the arc's end, plus the velocity change and the turn of the (r, theta) frame from the position change
+    double vr = (end.pos[0]*end.vel[0] + end.pos[1]*end.vel[1])/rho;
+    double vtheta = (end.pos[0]*end.vel[1] - end.pos[1]*end.vel[0])/rho;
+    double vHorizontal = sqrt(end.vel[0]*end.vel[0] + end.vel[1]*end.vel[1]);
+    double velArc = sqrt(pow(cConstants->vr_fin_ast - vr, 2) + pow(cConstants->vtheta_fin_ast - vtheta, 2));
+    velUpper = velArc + distVel + vHorizontal*fmin(dPhi, 2.0);
+}
+
+__host__ __device__ bool pruneTrajectory(Individual & individual, const elements<double> & y, const double & timeLeft, const double & massExpelled, const pruneBounds & bounds, const cudaConstants* cConstants) {
+    double posLower, velUpper;
+    reachableDiffs(y, timeLeft, massExpelled, bounds, cConstants, posLower, velUpper);
+    if (posLower > bounds.posCutoff && velUpper < bounds.velCutoff) {
+        individual.finalPos = y;
+        individual.posDiff = posLower;
+        individual.velDiff = 0;
+        individual.getCost(cConstants);
+        individual.prunedTime = timeLeft;
+        return true;
+    }
+    return false;
+}
+
+pruneStats countPruned(const Individual * individuals, int count, const pruneBounds & bounds) {
+    pruneStats stats;
+    stats.evaluated = count;
+    stats.pruned = 0;
+    stats.posCutoff = bounds.posCutoff;
+    stats.velCutoff = bounds.velCutoff;
+
+    double tripTotal = 0, prunedTotal = 0;
+    for (int i = 0; i < count; i++) {
+        tripTotal += individuals[i].startParams.tripTime;
+        if (individuals[i].prunedTime > 0) {
+            stats.pruned++;
+            prunedTotal += individuals[i].prunedTime;
+        }
+    }
+    stats.workSaved = (tripTotal > 0) ? prunedTotal / tripTotal : 0;
+    return stats;
+}
@@ -0,0 +1,54 @@
+#ifndef PRUNING_H
+#define PRUNING_H
+
+#include "../Motion_Eqns/kepler.h"            // for keplerPropagate(), the coast arc the reachable states are centered on
+#include "../Genetic_Algorithm/individuals.h" // for Individual
+
+// What trajectories are checked against at each of the prune_checkpoints while they are integrated
+// Made by the GenerationEngine from the last generation's survivor boundaries, the same for every individual of a generation
+struct pruneBounds {
+    double posCutoff;  // posDiff of the last posDiff survivor or the last individual kept, whichever is more, times prune_margin
+    double velCutoff;  // velDiff of the last velDiff survivor over prune_margin, INFINITY if no survivors are chosen by velDiff
+    double maxAccel;   // most acceleration the thruster can give the spacecraft, at dry mass (AU/s^2)
+    double exhaustVel; // most thrust per fuel flow of the thruster, sets the delta-v left in the fuel (AU/s)
+    int checkpoints;   // prune_checkpoints, evenly spaced over each trip
+};
+
+// Counts for the individuals evaluated in a generation
+struct pruneStats {
+    int evaluated;    // individuals integrated
+    int pruned;       // of those, stopped early
+    double workSaved; // share of the evaluated trip time that was not integrated
+    double posCutoff; // cutoffs they were checked against
+    double velCutoff;
+};
+
+// Fills in maxAccel and exhaustVel for cConstants' thruster, found by sampling the input power up to the thruster's P0
+// (calc_accel() never gives it more power than that), both are 0 for NO_THRUST
+void initPruneThruster(pruneBounds & bounds, const cudaConstants* cConstants);
+
+// Estimated bounds on the posDiff and velDiff a trajectory can still reach by the end of its trip, a heuristic and not strict
+// The final state is near where the coast (Kepler) arc from y ends: the thrust moves it by at most what maxAccel (or the delta-v
+// left in the fuel) gives over the time left, using the linearized motion about a circular orbit of the arc's semi-major axis
+// Eccentric orbits, and thrust large enough that the linearization does not hold, can reach past these, prune_margin allows for that
+// Input: y - current state, timeLeft - trip time left (s), massExpelled - fuel used so far (kg)
+//        bounds - thruster limits from initPruneThruster()
+//        cConstants - asteroid's final position and velocity, wet_mass and fuel_mass
+// Output: posLower - estimate of the lowest posDiff a final state can have, velUpper - of the highest velDiff
+//         (0 and INFINITY if theta is negative, as posDiff's fmod() is then not in [0, 2 pi))
+__host__ __device__ void reachableDiffs(const elements<double> & y, const double & timeLeft, const double & massExpelled, const pruneBounds & bounds, const cudaConstants* cConstants, double & posLower, double & velUpper);
+
+// Checks a trajectory at a checkpoint, stopping it if by reachableDiffs() it can no longer be a survivor
+// As the bounds are estimates and the cutoffs are last generation's, a trajectory that would have been a survivor can be stopped
+// Input: individual - being integrated, y, timeLeft, massExpelled, bounds, cConstants - as in reachableDiffs()
+// Output: returns true if its estimated bounds do not reach a posDiff below posCutoff or a velDiff above velCutoff,
+//         then individual's finalPos is y, posDiff is the lower bound, velDiff is 0 (so it is never a velDiff survivor),
+//         cost is set from them, and prunedTime is timeLeft
+__host__ __device__ bool pruneTrajectory(Individual & individual, const elements<double> & y, const double & timeLeft, const double & massExpelled, const pruneBounds & bounds, const cudaConstants* cConstants);
+
+// Counts the pruned individuals after they have been evaluated
+// Input: individuals, count - the evaluated individuals, bounds - what they were checked against
+pruneStats countPruned(const Individual * individuals, int count, const pruneBounds & bounds);
+
+#include "pruning.cpp"
+#endif
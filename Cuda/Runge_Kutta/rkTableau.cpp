@@ -0,0 +1,192 @@
+#include <math.h> // for sqrt and fabs
+
+// Dormand-Prince 5(4)
+__host__ __device__ constexpr double dormandPrince5Tableau::c(int i) {
+    constexpr double C[7] = {0, 1.0/5.0, 3.0/10.0, 4.0/5.0, 8.0/9.0, 1.0, 1.0};
+    return C[i];
+}
+
+__host__ __device__ constexpr double dormandPrince5Tableau::a(int i, int j) {
+    // Stage 6 is at the new value (its row is b)
+    constexpr double A[7][7] = {
+        {0},
+        {1.0/5.0},
+        {3.0/40.0, 9.0/40.0},
+        {44.0/45.0, -56.0/15.0, 32.0/9.0},
+        {19372.0/6561.0, -25360.0/2187.0, 64448.0/6561.0, -212.0/729.0},
+        {9017.0/3168.0, -355.0/33.0, 46732.0/5247.0, 49.0/176.0, -5103.0/18656.0},
+        {35.0/384.0, 0, 500.0/1113.0, 125.0/192.0, -2187.0/6784.0, 11.0/84.0}
+    };
+    return A[i][j];
+}
+
+__host__ __device__ constexpr double dormandPrince5Tableau::b(int j) {
+    constexpr double B[7] = {35.0/384.0, 0, 500.0/1113.0, 125.0/192.0, -2187.0/6784.0, 11.0/84.0, 0};
+    return B[j];
+}
+
+__host__ __device__ constexpr double dormandPrince5Tableau::e(int j) {
+    constexpr double E[7] = {71.0/57600.0, 0, -71.0/16695.0, 71.0/1920.0, -17253.0/339200.0, 22.0/525.0, -1.0/40.0};
+    return E[j];
+}
+
+__host__ __device__ constexpr double dormandPrince5Tableau::e3(int) {
+    return 0;
+}
+
+// Verner 6(5)
+__host__ __device__ constexpr double verner65Tableau::c(int i) {
+    constexpr double C[8] = {0, 1.0/6.0, 4.0/15.0, 2.0/3.0, 5.0/6.0, 1.0, 1.0/15.0, 1.0};
+    return C[i];
+}
+
+__host__ __device__ constexpr double verner65Tableau::a(int i, int j) {
+    constexpr double A[8][8] = {
+        {0},
+        {1.0/6.0},
+        {4.0/75.0, 16.0/75.0},
+        {5.0/6.0, -8.0/3.0, 5.0/2.0},
+        {-165.0/64.0, 55.0/6.0, -425.0/64.0, 85.0/96.0},
+        {12.0/5.0, -8.0, 4015.0/612.0, -11.0/36.0, 88.0/255.0},
+        {-8263.0/15000.0, 124.0/75.0, -643.0/680.0, -81.0/250.0, 2484.0/10625.0, 0},
+        {3501.0/1720.0, -300.0/43.0, 297275.0/52632.0, -319.0/2322.0, 24068.0/84065.0, 0, 3850.0/26703.0}
+    };
+    return A[i][j];
+}
+
+__host__ __device__ constexpr double verner65Tableau::b(int j) {
+    constexpr double B[8] = {3.0/40.0, 0, 875.0/2244.0, 23.0/72.0, 264.0/1955.0, 0, 125.0/11592.0, 43.0/616.0};
+    return B[j];
+}
+
+__host__ __device__ constexpr double verner65Tableau::e(int j) {
+    // b minus the fifth order weights (13/160, 0, 2375/5984, 5/16, 12/85, 3/44, 0, 0)
+    constexpr double E[8] = {-1.0/160.0, 0, -125.0/17952.0, 1.0/144.0, -12.0/1955.0, -3.0/44.0, 125.0/11592.0, 43.0/616.0};
+    return E[j];
+}
+
+__host__ __device__ constexpr double verner65Tableau::e3(int) {
+    return 0;
+}
+
+// DOP853, the coefficients of Hairer's dop853.f to 30 digits (some are irrational, with sqrt(6))
+__host__ __device__ constexpr double dop853Tableau::c(int i) {
+    constexpr double C[12] = {0, 0.526001519587677318785587544488e-01, 0.789002279381515978178381316732e-01, 0.118350341907227396726757197510, 0.281649658092772603273242802490, 0.333333333333333333333333333333, 0.25, 0.307692307692307692307692307692, 0.651282051282051282051282051282, 0.6, 0.857142857142857142857142857142, 1.0};
+    return C[i];
+}
+
+__host__ __device__ constexpr double dop853Tableau::a(int i, int j) {
+    constexpr double A[12][12] = {
+        {0},
+        {5.26001519587677318785587544488e-2},
+        {1.97250569845378994544595329183e-2, 5.91751709536136983633785987549e-2},
+        {2.95875854768068491816892993775e-2, 0, 8.87627564304205475450678981324e-2},
+        {2.41365134159266685502369798665e-1, 0, -8.84549479328286085344864962717e-1, 9.24834003261792003115737966543e-1},
+        {3.7037037037037037037037037037e-2, 0, 0, 1.70828608729473871279604482173e-1, 1.25467687566822425016691814123e-1},
+        {3.7109375e-2, 0, 0, 1.70252211019544039314978060272e-1, 6.02165389804559606850219397283e-2, -1.7578125e-2},
+        {3.70920001185047927108779319836e-2, 0, 0, 1.70383925712239993810214054705e-1, 1.07262030446373284651809199168e-1, -1.53194377486244017527936158236e-2, 8.27378916381402288758473766002e-3},
+        {6.24110958716075717114429577812e-1, 0, 0, -3.36089262944694129406857109825, -8.68219346841726006818189891453e-1, 2.75920996994467083049415600797e1, 2.01540675504778934086186788979e1, -4.34898841810699588477366255144e1},
+        {4.77662536438264365890433908527e-1, 0, 0, -2.48811461997166764192642586468, -5.90290826836842996371446475743e-1, 2.12300514481811942347288949897e1, 1.52792336328824235832596922938e1, -3.32882109689848629194453265587e1, -2.03312017085086261358222928593e-2},
+        {-9.3714243008598732571704021658e-1, 0, 0, 5.18637242884406370830023853209, 1.09143734899672957818500254654, -8.14978701074692612513997267357, -1.85200656599969598641566180701e1, 2.27394870993505042818970056734e1, 2.49360555267965238987089396762, -3.0467644718982195003823669022},
+        {2.27331014751653820792359768449, 0, 0, -1.05344954667372501984066689879e1, -2.00087205822486249909675718444, -1.79589318631187989172765950534e1, 2.79488845294199600508499808837e1, -2.85899827713502369474065508674, -8.87285693353062954433549289258, 1.23605671757943030647266201528e1, 6.43392746015763530355970484046e-1}
+    };
+    return A[i][j];
+}
+
+__host__ __device__ constexpr double dop853Tableau::b(int j) {
+    constexpr double B[12] = {5.42937341165687622380535766363e-2, 0, 0, 0, 0, 4.45031289275240888144113950566, 1.89151789931450038304281599044, -5.8012039600105847814672114227, 3.1116436695781989440891606237e-1, -1.52160949662516078556178806805e-1, 2.01365400804030348374776537501e-1, 4.47106157277725905176885569043e-2};
+    return B[j];
+}
+
+__host__ __device__ constexpr double dop853Tableau::e(int j) {
+    // b minus the fifth order weights
+    constexpr double E[12] = {0.1312004499419488073250102996e-1, 0, 0, 0, 0, -0.1225156446376204440720569753e+1, -0.4957589496572501915214079952, 0.1664377182454986536961530415e+1, -0.3503288487499736816886487290, 0.3341791187130174790297318841, 0.8192320648511571246570742613e-1, -0.2235530786388629525884427845e-1};
+    return E[j];
+}
+
+__host__ __device__ constexpr double dop853Tableau::e3(int j) {
+    // b minus the third order weights (0.244094488188976377952755905512, 0.733846688281611857341361741547, and 0.220588235294117647058823529412e-1 in places 0, 8, and 11)
+    constexpr double E[12] = {-0.189800754072407615714702328876, 0, 0, 0, 0, 4.45031289275240888144113950566, 1.89151789931450038304281599044, -5.8012039600105847814672114227, -0.422682321323791962932445679177, -1.52160949662516078556178806805e-1, 2.01365400804030348374776537501e-1, 0.0226517921983608258118062039631};
+    return E[j];
+}
+
+template <class Tab> __host__ __device__ constexpr double tableauWeight(int row, int j) {
+    return (row == TABLEAU_LOW_ERROR_ROW) ? Tab::e3(j) : ((row == TABLEAU_ERROR_ROW) ? Tab::e(j) : ((row == Tab::stages) ? Tab::b(j) : Tab::a(row, j)));
+}
+
+template <class Tab, int Row, int J, int End> template <class E> __host__ __device__ __forceinline__ void tableauSum<Tab, Row, J, End>::add(E & sum, const E * k) {
+    // constexpr so the weight is found when compiling, and the zero check removes the term rather than being done each step
+    constexpr double weight = tableauWeight<Tab>(Row, J);
+    if (weight != 0) {
+        addScaled(sum, k[J], weight);
+    }
+    tableauSum<Tab, Row, J+1, End>::add(sum, k);
+}
+
+template <class Tab, int I> template <class E, class S> __host__ __device__ __forceinline__ void tableauStages<Tab, I>::run(const E & y, E * k, S & stage) {
+    tableauStages<Tab, I-1>::run(y, k, stage);
+
+    constexpr double c = Tab::c(I-1);
+    E yStage = y;
+    tableauSum<Tab, I-1, 0, I-1>::add(yStage, k);
+    stage(c, yStage, k[I-1]);
+}
+
+template <class Tab, class E, class S> __host__ __device__ __forceinline__ void rkTableauStep(E & y, E & error, E * k, S & stage) {
+    if (Tab::fsal) {
+        // New value, then the last stage at it
+        tableauStages<Tab, Tab::stages-1>::run(y, k, stage);
+        tableauSum<Tab, Tab::stages, 0, Tab::stages>::add(y, k);
+        constexpr double c = Tab::c(Tab::stages-1);
+        stage(c, y, k[Tab::stages-1]);
+    }
+    else {
+        tableauStages<Tab, Tab::stages>::run(y, k, stage);
+
+        // New value
+        tableauSum<Tab, Tab::stages, 0, Tab::stages>::add(y, k);
+    }
+
+    // Error, starting from 0 (E() is all zeros for both elements<T> and elementsBatch)
+    error = E();
+    tableauSum<Tab, TABLEAU_ERROR_ROW, 0, Tab::stages>::add(error, k);
+    if (Tab::blendedError) {
+        E lowError = E();
+        tableauSum<Tab, TABLEAU_LOW_ERROR_ROW, 0, Tab::stages>::add(lowError, k);
+        blendError(error, lowError);
+    }
+}
+
+template <class T> __host__ __device__ __forceinline__ void addScaled(elements<T> & out, const elements<T> & k, const double & a) {
+    // Same arithmetic as out + k*a, without the temporaries
+    out.r += k.r*a;
+    out.theta += k.theta*a;
+    out.z += k.z*a;
+    out.vr += k.vr*a;
+    out.vtheta += k.vtheta*a;
+    out.vz += k.vz*a;
+}
+
+// One component of blendError(), the blend dop853 uses for the whole norm applied to a single component
+template <class T> __host__ __device__ T blendErrorComponent(const T & error, const T & lowError) {
+    T denominator = error*error + 0.01*lowError*lowError;
+    if (denominator <= 0) {
+        return 0;
+    }
+    return error*fabs(error)/sqrt(denominator);
+}
+
+template <class T> __host__ __device__ void blendError(elements<T> & error, const elements<T> & lowError) {
+    error = elements<T>(blendErrorComponent(error.r, lowError.r), blendErrorComponent(error.theta, lowError.theta), blendErrorComponent(error.z, lowError.z),
+                        blendErrorComponent(error.vr, lowError.vr), blendErrorComponent(error.vtheta, lowError.vtheta), blendErrorComponent(error.vz, lowError.vz));
+}
+
+__host__ __device__ int tableauErrorOrder(const int & tableau) {
+    if (tableau == cudaConstants::DOP853_TABLEAU) {
+        return dop853Tableau::errorOrder;
+    }
+    else if (tableau == cudaConstants::VERNER65_TABLEAU) {
+        return verner65Tableau::errorOrder;
+    }
+    return dormandPrince5Tableau::errorOrder;
+}
@@ -0,0 +1,114 @@
+#ifndef RKTABLEAU_H
+#define RKTABLEAU_H
+
+// Butcher tableaus of the embedded Runge-Kutta pairs rkCalc() can step with, chosen by rk_tableau in the config
+// Each tableau is a struct with
+//     stages     - number of stages, the derivative evaluations per step
+//     order      - order of the solution the step returns
+//     errorOrder - order the error estimate behaves as, sets the exponent of the step size control in calc_piStep()
+//     blendedError - true if the error is a blend of two embedded solutions (see blendError()), false if it is e() alone
+//     fsal       - true if the last stage is at the new value (its row of a is b, "first same as last")
+//     c(i), a(i, j) - node and coefficients of stage i (from 0), a(i, j) is 0 for j >= i
+//     b(j)  - weights of the solution
+//     e(j)  - error weights, b(j) minus the weights of the embedded solution
+//     e3(j) - weights of the second error estimate when blendedError is true
+// The coefficients are constexpr functions, the sums below are unrolled at compile time so each coefficient is a constant
+// in the generated code and the zeros are dropped, as when the coefficients were written out in rkCalc() by hand
+// The unrolling helpers are __forceinline__ so the host compiler flattens them into one step as well as nvcc does
+// Coefficients were checked against the order conditions (every rooted tree up to the order) with exact fractions
+
+// Dormand-Prince 5(4), from MATLAB's ode45, the original coefficients of rkCalc() and rkCalcEarth()
+// The last stage is at the new value, so its derivative is also the first of the next step
+struct dormandPrince5Tableau {
+    static const int stages = 7;
+    static const int order = 5;
+    static const int errorOrder = 4;
+    static const bool blendedError = false;
+    static const bool fsal = true;
+    __host__ __device__ static constexpr double c(int i);
+    __host__ __device__ static constexpr double a(int i, int j);
+    __host__ __device__ static constexpr double b(int j);
+    __host__ __device__ static constexpr double e(int j);
+    __host__ __device__ static constexpr double e3(int j);
+};
+
+// Verner 6(5), J.H. Verner, SIAM J. Numer. Anal. 1978, the pair used by IMSL's DVERK
+struct verner65Tableau {
+    static const int stages = 8;
+    static const int order = 6;
+    static const int errorOrder = 5;
+    static const bool blendedError = false;
+    static const bool fsal = false;
+    __host__ __device__ static constexpr double c(int i);
+    __host__ __device__ static constexpr double a(int i, int j);
+    __host__ __device__ static constexpr double b(int j);
+    __host__ __device__ static constexpr double e(int j);
+    __host__ __device__ static constexpr double e3(int j);
+};
+
+// Dormand-Prince 8(5,3), Hairer's DOP853 (Hairer, Norsett and Wanner, Solving ODEs I, section II.10)
+// The error blends a fifth and a third order estimate, which behaves as order 7 so DOP853 uses 1/8 as its step size exponent
+struct dop853Tableau {
+    static const int stages = 12;
+    static const int order = 8;
+    static const int errorOrder = 7;
+    static const bool blendedError = true;
+    static const bool fsal = false;
+    __host__ __device__ static constexpr double c(int i);
+    __host__ __device__ static constexpr double a(int i, int j);
+    __host__ __device__ static constexpr double b(int j);
+    __host__ __device__ static constexpr double e(int j);
+    __host__ __device__ static constexpr double e3(int j);
+};
+
+// Rows of tableauWeight() other than the stages, the solution weights are row Tab::stages
+enum TABLEAU_ROWS { TABLEAU_ERROR_ROW = -1, TABLEAU_LOW_ERROR_ROW = -2 };
+
+// Weight of k[j] in row row of Tab, a(row, j) for a stage, b(j) for row Tab::stages, or e(j) or e3(j) for the error rows
+template <class Tab> __host__ __device__ constexpr double tableauWeight(int row, int j);
+
+// Adds k[j]*tableauWeight(Row, j) for j = J .. End-1 onto sum, each weight is a compile time constant and zeros are skipped
+// The terms are added in order of j, so the rounding matches writing the sum out as sum + k1*w1 + k2*w2 + ...
+template <class Tab, int Row, int J, int End> struct tableauSum {
+    template <class E> __host__ __device__ __forceinline__ static void add(E & sum, const E * k);
+};
+template <class Tab, int Row, int End> struct tableauSum<Tab, Row, End, End> {
+    template <class E> __host__ __device__ __forceinline__ static void add(E &, const E *) {}
+};
+
+// Evaluates stages 0 .. I-1 of Tab in order, stage i is stage(c(i), y + sum of a(i, j)*k[j], k[i])
+template <class Tab, int I> struct tableauStages {
+    template <class E, class S> __host__ __device__ __forceinline__ static void run(const E & y, E * k, S & stage);
+};
+template <class Tab> struct tableauStages<Tab, 0> {
+    template <class E, class S> __host__ __device__ __forceinline__ static void run(const E &, E *, S &) {}
+};
+
+// One step of the embedded Runge-Kutta pair Tab, shared by rkCalc(), rkCalcEarth(), and rk4SimpleBatch()
+// With Tab::fsal the new value is found before the last stage, which is then evaluated at it
+// Input: y - value at the start of the step
+//        k - room for Tab::stages values
+//        stage - called as stage(c, yStage, k) to set k to the step size times the derivative at yStage and
+//                time curTime + c*stepSize (k values include the step size, see calc_k())
+// Output: y is the value at the end of the step, error is the difference between it and the embedded solution
+//         (blended with the second estimate when Tab::blendedError), k holds the stages
+// E is elements<T> or elementsBatch, with addScaled() and blendError() for it
+template <class Tab, class E, class S> __host__ __device__ __forceinline__ void rkTableauStep(E & y, E & error, E * k, S & stage);
+
+// out = out + k*a, the elements<T> version of the batch addScaled() so tableauSum works on either
+template <class T> __host__ __device__ __forceinline__ void addScaled(elements<T> & out, const elements<T> & k, const double & a);
+
+// Blends DOP853's two error estimates for each component, error*|error|/sqrt(error^2 + 0.01*lowError^2), so the step size follows
+// the fifth order estimate but a third order estimate much larger than it still shortens the step
+// This is not quite Hairer's dop853, which blends the two summed error norms (err^2/sqrt(err^2 + 0.01*err3^2)) rather than each
+// component. The blend is kept per component so the step still has a single error vector, which both calc_scalingFactor() (SCALE)
+// and calc_errorNorm() (PI) take, as for the other pairs. It can differ from Hairer's when the two estimates are largest in different components
+// Input: error - fifth order error estimate, lowError - third order error estimate
+// Output: error is the blended estimate
+template <class T> __host__ __device__ void blendError(elements<T> & error, const elements<T> & lowError);
+
+// errorOrder of the tableau rk_tableau selects (a cudaConstants::RK_TABLEAU value), for calc_piStep()
+__host__ __device__ int tableauErrorOrder(const int & tableau);
+
+#include "rkTableau.cpp"
+#endif
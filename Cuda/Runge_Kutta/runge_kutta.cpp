@@ -20,6 +20,7 @@ template <class T> void rk4sys(const T & timeInitial, const T & timeFinal, T *ti
     // u - current position
     // error needs to be defined, but not being used
     elements<T> u, error;
+    stageCache<T> cache; // carries the last stage of each step to the next
 
     // Set the first element of the solution vector to the initial conditions
     u = y0;
@@ -50,7 +51,7 @@ template <class T> void rk4sys(const T & timeInitial, const T & timeFinal, T *ti
         }
         
         //calculate new position
-        rkCalc(curTime, timeFinal, stepSize, u, coeff, accel_output[n], error);
+        rkCalc(curTime, timeFinal, stepSize, u, coeff, accel_output[n], error, cudaConstants::DP5_TABLEAU, &cache);
 
         //array of time output as t         
         curTime += stepSize;
@@ -90,6 +91,7 @@ template <class T> void rk4Simple(const T & timeInitial, const T & timeFinal, co
     stepSize = (timeFinal-timeInitial) / cConstants->cpu_numsteps;
     
     elements<T> error;
+    stageCache<T> cache; // carries the last stage of each step to the next
     bool coast;
     
     while (curTime < timeFinal) {  // iterate until time is equal to the stop time
@@ -106,7 +108,7 @@ template <class T> void rk4Simple(const T & timeInitial, const T & timeFinal, co
         }
 
         //calculate k values
-        rkCalc(curTime, timeFinal, stepSize, y_new, coeff, accel, error); 
+        rkCalc(curTime, timeFinal, stepSize, y_new, coeff, accel, error, cudaConstants::DP5_TABLEAU, &cache); 
 
         //array of time output as t         
         curTime += stepSize;
@@ -141,11 +143,12 @@ template <class T> void rk4Reverse(const T & timeInitial, const T & timeFinal, c
     // Set the first element of the solution vector to the conditions of earth on impact date (Oct. 5, 2022)
     y_new = y0;
     elements<T> error;
+    stageCache<T> cache; // carries k7 of each step to k1 of the next
     T curTime = timeFinal; // setting time equal to the start time
 
     while( curTime > timeInitial) {  // iterates in reverse
         //calculate k values
-        rkCalcEarth(curTime, timeFinal, stepSize, y_new, error);
+        rkCalcEarth<T>(curTime, timeFinal, stepSize, y_new, error, nullptr, &cache);
 
         //array of time output as t         
         curTime -= stepSize;
@@ -168,72 +171,226 @@ template <class T> void rk4Reverse(const T & timeInitial, const T & timeFinal, c
     } //end of while
 }
 
-template <class T> __host__ __device__ void rkCalc(T & curTime, const T & timeFinal, T stepSize, elements<T> & y_new, coefficients<T> & coeff, const T & accel, 
-                                                    elements<T> & error) {
+template <class T, class P> __host__ __device__ void rkCalc(T & curTime, const T & timeFinal, T stepSize, elements<T> & y_new, P & profile, const T & accel, 
+                                                    elements<T> & error, const int & tableau, stageCache<T> * cache, elements<T> * stages, const T & mu) {
+    // Without a cache from the caller the stages of this step still share the thrust angles through a local one
+    stageCache<T> localCache;
+    stageCache<T> & stepCache = (cache != nullptr) ? *cache : localCache;
 
-    // k variables for Runge-Kutta calculation of y_new
-    elements<T> k1, k2, k3, k4, k5, k6, k7;
-    // Coefficients from MATLAB's implementation of ode45
+    if (tableau == cudaConstants::DOP853_TABLEAU) {
+        rkCalcTableau<dop853Tableau>(curTime, timeFinal, stepSize, y_new, profile, accel, error, stepCache, stages, mu);
+    }
+    else if (tableau == cudaConstants::VERNER65_TABLEAU) {
+        rkCalcTableau<verner65Tableau>(curTime, timeFinal, stepSize, y_new, profile, accel, error, stepCache, stages, mu);
+    }
+    else {
+        rkCalcTableau<dormandPrince5Tableau>(curTime, timeFinal, stepSize, y_new, profile, accel, error, stepCache, stages, mu);
+    }
+}
+
+template <class Tab, class T, class P> __host__ __device__ void rkCalcTableau(const T & curTime, const T & timeFinal, const T & stepSize, elements<T> & y_new, P & profile, const T & accel, 
+                                                                     elements<T> & error, stageCache<T> & cache, elements<T> * stages, const T & mu) {
+    // k variables for Runge-Kutta calculation of y_new, kept in stages if given for dense output
+    elements<T> k[Tab::stages];
     // Our calculation of k has the time step built into it (see motion_equations.cpp)
-    k1 = calc_k(stepSize, y_new, coeff, accel, curTime, timeFinal); 
-    k2 = calc_k(stepSize, y_new+k1*(static_cast <double> (1)/static_cast <double> (5)), coeff, accel, curTime+((static_cast <double> (1)/static_cast <double> (5))*stepSize), timeFinal); 
-    k3 = calc_k(stepSize, y_new+k1*(static_cast <double> (3)/static_cast <double> (40))+k2*(static_cast <double> (9)/static_cast <double> (40)), coeff, accel, curTime+((static_cast <double> (3)/static_cast <double> (10))*stepSize), timeFinal);   
-    k4 = calc_k(stepSize, y_new+k1*(static_cast <double> (44)/static_cast <double> (45))+k2*(static_cast <double> (-56)/static_cast <double> (15))+k3*(static_cast <double> (32)/static_cast <double> (9)), coeff, accel, curTime+((static_cast <double> (4)/static_cast <double> (5))*stepSize), timeFinal); 
-    k5 = calc_k(stepSize, y_new+k1*(static_cast <double> (19372)/static_cast <double> (6561))+k2*(static_cast <double> (-25360)/static_cast <double> (2187))+k3*(static_cast <double> (64448)/static_cast <double> (6561))+k4*(static_cast <double> (-212)/static_cast <double> (729)), coeff, accel, curTime+((static_cast <double> (8)/static_cast <double> (9))*stepSize), timeFinal); 
-    k6 = calc_k(stepSize, y_new+k1*(static_cast <double> (9017)/static_cast <double> (3168))+k2*(static_cast <double> (-355)/static_cast <double> (33))+k3*(static_cast <double> (46732)/static_cast <double> (5247))+k4*(static_cast <double> (49)/static_cast <double> (176))+k5*(static_cast <double> (-5103)/static_cast <double> (18656)), coeff, accel, curTime+stepSize, timeFinal);  
-    k7 = calc_k(stepSize, y_new+k1*(static_cast <double> (35)/static_cast <double> (384))+k3*(static_cast <double> (500)/static_cast <double> (1113))+k4*(static_cast <double> (125)/static_cast <double> (192))+k5*(static_cast <double> (-2187)/static_cast <double> (6784))+k6*(static_cast <double> (11)/static_cast <double> (84)), coeff, accel, curTime+stepSize, timeFinal);  
-
-    // New value
-    y_new = y_new + k1*(static_cast <double> (35)/static_cast <double> (384)) + k3*(static_cast <double> (500)/static_cast <double> (1113)) + k4*(static_cast <double> (125)/static_cast <double> (192)) - k5*(static_cast <double> (2187)/static_cast <double> (6784)) + k6*(static_cast <double> (11)/static_cast <double> (84)) + k7*(static_cast <double> (0)/static_cast <double> (40));  
-
-    // Error 
-    // See the original algorithm by J.R. Dormand and P.J. Prince, JCAM 1980 and its implementation in MATLAB's ode45
-    // Dormand-Prince : no error between GPU and CPU
-    //y_prev = k1*5179./57600 + k3*7571./16695 + k4*393./640 - k5*92097./339200 + k6*187./2100 + k7*1./40;  
-    //error = y_new-y_prev;
-
-    // MATLAB code : ERROR between GPU and CPU
-    //error = k1*(71)/(57600) + k3*(-71)/(16695) + k4*(71)/(1920)
-    //- k5*(17253)/(339200) + k6*(22)/(525) + k7*(-1)/(40);
-
-    // (outdated comment, but still important) Without k7 : no error between GPU and CPU (this has to do with the comment below)
-    
-    // Comonents of error are going to be really small. Need to make sure they are not too small to do anything with in calc_scalingFactor
-    error =  ((k1*(static_cast <double> (71)/static_cast <double> (57600))) + (k3*(static_cast <double> (-71)/static_cast <double> (16695))) + (k4*(static_cast <double> (71)/static_cast <double> (1920)))  + (k5*(static_cast <double> (-17253)/static_cast <double> (339200))) + (k6*(static_cast <double> (22)/static_cast <double> (525)))) + (k7*(static_cast <double> (-1)/static_cast <double> (40)));
+    // The last stage is only worth keeping when it is at y_new, where the next step starts
+    thrustStage<T, P> stage(curTime, stepSize, timeFinal, profile, accel, cache, Tab::fsal, Tab::stages, mu);
+
+    // Stages, new value, and error of the pair Tab (see rkTableau.h for the tableaus and where their coefficients come from)
+    // Components of error are going to be really small. Need to make sure they are not too small to do anything with in calc_scalingFactor
+    rkTableauStep<Tab>(y_new, error, (stages != nullptr) ? stages : k, stage);
+}
+
+template <class T> __host__ __device__ stageCache<T>::stageCache() : rateSet(false), anglesSet(false), angleTime(0), angleCoast(false) {
+}
+
+template <class T, class P> __host__ __device__ thrustStage<T, P>::thrustStage(const T & curTime, const T & stepSize, const T & timeFinal, P & profile, const T & accel,
+                                                                               stageCache<T> & cache, const bool & keepLast, const int & stages, const T & mu)
+    : curTime(curTime), stepSize(stepSize), timeFinal(timeFinal), accel(accel), mu(mu), profile(profile), cache(cache), stage(0), lastStage(keepLast ? stages - 1 : -1) {
+}
+
+template <class T, class P> __host__ __device__ void thrustStage<T, P>::operator()(const double & c, const elements<T> & y, elements<T> & k) {
+    // Angles are found again at a new time, or if the thrust has come on or gone off since they were found (coasting leaves them at 0)
+    T stageTime = curTime + c*stepSize;
+    bool coast = (accel == 0);
+    if (!cache.anglesSet || stageTime != cache.angleTime || coast != cache.angleCoast) {
+        cache.angles = calc_stageAngles(profile, accel, stageTime, timeFinal);
+        cache.angleTime = stageTime;
+        cache.angleCoast = coast;
+        cache.anglesSet = true;
+    }
+
+    // Only the first stage can be at the value kept from the step before
+    elements<T> rate;
+    if (stage == 0 && cache.rateSet && y == cache.rateY) {
+        rate = cache.rate;
+    }
+    else {
+        rate = calc_gravityRate(y, mu);
+    }
+    if (stage == lastStage) {
+        cache.rateY = y;
+        cache.rate = rate;
+        cache.rateSet = true;
+    }
+    stage++;
+
+    k = calc_kFromRate(stepSize, rate, cache.angles, accel);
+}
+
+template <class T, class P> __host__ __device__ T coastSwitchTime(P & profile, const T & t0, const T & t1, const T & timeFinal, thruster<T> & thrust, bool thrustAtT0) {
+    T before = t0, after = t1;
+    while (after - before > 1e-12*timeFinal) {
+        T mid = (before + after)/2;
+        if (calc_coast(profile, mid, timeFinal, thrust) == thrustAtT0) {
+            before = mid;
+        }
+        else {
+            after = mid;
+        }
+    }
+    return after;
+}
+
+template <class T, class P> __host__ __device__ bool keplerCoast(T & curTime, const T & startTime, const T & timeFinal, T & stepSize, elements<T> & y, P & profile,
+                                                             thruster<T> & thrust, const T & massFuelSpent, const cudaConstants* cConstant, const T & mu) {
+    cartesianState<T> state = cylindricalToCartesian(y);
+
+    // Closest approach of the orbit, h^2/(mu (1 + e))
+    T h[3] = {state.pos[1]*state.vel[2] - state.pos[2]*state.vel[1],
+              state.pos[2]*state.vel[0] - state.pos[0]*state.vel[2],
+              state.pos[0]*state.vel[1] - state.pos[1]*state.vel[0]};
+    T h2 = h[0]*h[0] + h[1]*h[1] + h[2]*h[2];
+    T radius = sqrt(state.pos[0]*state.pos[0] + state.pos[1]*state.pos[1] + state.pos[2]*state.pos[2]);
+    T v2 = state.vel[0]*state.vel[0] + state.vel[1]*state.vel[1] + state.vel[2]*state.vel[2];
+    T energy = v2/2 - mu/radius;
+    T eccentricity = sqrt(fmax(static_cast<T>(0), 1 + 2*energy*h2/(mu*mu)));
+    if (h2/(mu*(1 + eccentricity)) < 0.5) {
+        return false;
+    }
+
+    // Time the thrust comes back on
+    T endTime = curTime;
+    if (cConstant->thruster_type == thruster<double>::NO_THRUST || massFuelSpent >= cConstant->fuel_mass) {
+        endTime = timeFinal;
+        stepSize = 0;
+    }
+    else if (cConstant->step_control == cudaConstants::PI_STEP) {
+        // Steps of the held size until one crosses the switch, the arc ends on it
+        bool thrustAtStart = calc_coast(profile, curTime, timeFinal, thrust);
+        do {
+            T stepStart = endTime;
+            endTime = fmin(endTime + stepSize, timeFinal);
+            if (calc_coast(profile, endTime, timeFinal, thrust)) {
+                if (!thrustAtStart) {
+                    endTime = coastSwitchTime(profile, stepStart, endTime, timeFinal, thrust, false);
+                }
+                break;
+            }
+        } while (endTime < timeFinal);
+    }
+    else {
+        do {
+            endTime += stepSize;
+
+            // Same limits as rk4SimpleIndividual()
+            if (stepSize > (timeFinal - startTime) / cConstant->min_numsteps) {
+                stepSize = (timeFinal - startTime) / cConstant->min_numsteps;
+            }
+            else if (stepSize < (timeFinal - startTime) / cConstant->max_numsteps) {
+                stepSize = (timeFinal - startTime) / cConstant->max_numsteps;
+            }
+            if ( (endTime + stepSize) > timeFinal) {
+                stepSize = (timeFinal - endTime);
+            }
+        } while (endTime < timeFinal && !calc_coast(profile, endTime, timeFinal, thrust));
+    }
+
+    // Propagated in pieces of at most half an orbit, so the angle each piece sweeps (in the direction of motion) is known to be
+    // under a full turn and theta can be kept unwrapped as the integration keeps it
+    int pieces = 1;
+    if (energy < 0) {
+        T axis = -mu/(2*energy);
+        T period = 2*M_PI*sqrt(axis*axis*axis/mu);
+        pieces = static_cast<int>(ceil((endTime - curTime)/(period/2)));
+        if (pieces < 1) {
+            pieces = 1;
+        }
+    }
+    T pieceTime = (endTime - curTime)/pieces;
+    T theta = y.theta;
+    for (int i = 0; i < pieces; i++) {
+        T before = atan2(state.pos[1], state.pos[0]);
+        state = keplerPropagate(state, pieceTime, mu);
+        T sweep = atan2(state.pos[1], state.pos[0]) - before;
+        if (h[2] >= 0) {
+            sweep = (sweep < 0) ? sweep + 2*M_PI : sweep;
+        }
+        else {
+            sweep = (sweep > 0) ? sweep - 2*M_PI : sweep;
+        }
+        theta += sweep;
+    }
+
+    y = cartesianToCylindrical(state, theta);
+    curTime = endTime;
+    return true;
 }
 
 // The stepSize value that is inputted is assumed to be a positive value
-template <class T> void rkCalcEarth(T & curTime, const T & timeFinal, T stepSize, elements<T> & y_new, elements<T> & error) {
+template <class T> void rkCalcEarth(T &, const T &, T stepSize, elements<T> & y_new, elements<T> & error, elements<T> * stages, stageCache<T> * cache) {
     // Runge-Kutta algorithm    
-    // k variables for Runge-Kutta calculation of y_new
-    elements<T> k1, k2, k3, k4, k5, k6, k7;
+    // k variables for Runge-Kutta calculation of y_new, kept in stages if given for dense output
+    elements<T> k[dormandPrince5Tableau::stages];
     
     stepSize *= -1; // Make this copy of stepSize negative as it goes backwards
 
     //calc_k multiplies all values by the stepSize internally.
-    k1 = calc_kEarth(stepSize, y_new, curTime, timeFinal);        
-    k2 = calc_kEarth(stepSize, y_new+(k1*(static_cast <double> (1)/static_cast <double> (5))), curTime+((static_cast <double> (1)/static_cast <double> (5))*stepSize), timeFinal);   
-    k3 = calc_kEarth(stepSize, y_new+(k1*(static_cast <double> (3)/static_cast <double> (40)))+(k2*(static_cast <double> (9)/static_cast <double> (40))), curTime+((static_cast <double> (3)/static_cast <double> (10))*stepSize), timeFinal);   
-    k4 = calc_kEarth(stepSize, y_new+(k1*(static_cast <double> (44)/static_cast <double> (45)))+(k2*(static_cast <double> (-56)/static_cast <double> (15)))+(k3*(static_cast <double> (32)/static_cast <double> (9))), curTime+((static_cast <double> (4)/static_cast <double> (5))*stepSize), timeFinal);    
-    k5 = calc_kEarth(stepSize, y_new+(k1*(static_cast <double> (19372)/static_cast <double> (6561)))+(k2*(static_cast <double> (-25360)/static_cast <double> (2187)))+(k3*(static_cast <double> (64448)/static_cast <double> (6561)))+(k4*(static_cast <double> (-212)/static_cast <double> (729))), curTime+((static_cast <double> (8)/static_cast <double> (9))*stepSize), timeFinal);        
-    k6 = calc_kEarth(stepSize, y_new+(k1*(static_cast <double> (9017)/static_cast <double> (3168)))+(k2*(static_cast <double> (-355)/static_cast <double> (33)))+(k3*(static_cast <double> (46732)/static_cast <double> (5247)))+(k4*(static_cast <double> (49)/static_cast <double> (176)))+(k5*(static_cast <double> (-5103)/static_cast <double> (18656))), curTime+stepSize, timeFinal);        
-    k7 = calc_kEarth(stepSize, y_new+(k1*(static_cast <double> (35)/static_cast <double> (384)))+(k3*(static_cast <double> (500)/static_cast <double> (1113)))+(k4*(static_cast <double> (125)/static_cast <double> (192)))+(k5*(static_cast <double> (-2187)/static_cast <double> (6784)))+(k6*(static_cast <double> (11)/static_cast <double> (84))), curTime+stepSize, timeFinal);  
+    stageCache<T> localCache;
+    earthStage<T> stage(stepSize, (cache != nullptr) ? *cache : localCache);
 
     //Error 
     //See the original algorithm by J.R. Dormand and P.J. Prince, JCAM 1980 and its implementation in MATLAB's ode45
-    //v = y_new + k1*5179/57600 + k3*7571/16695 + k4*393/640 - k5*92097/339200 + k6*187/2100 + k7*1/40;  
+    rkTableauStep<dormandPrince5Tableau>(y_new, error, (stages != nullptr) ? stages : k, stage);
+}
 
-    //New value
-    //u = y + 35/384*k1 + 500/1113*k3 + 125/192*k4 - 2187/6784*k5 + 11/84*k6
-    y_new = y_new + (k1*(static_cast <double> (35)/static_cast <double> (384))) + (k3*(static_cast <double> (500)/static_cast <double> (1113))) + (k4*(static_cast <double> (125)/static_cast <double> (192))) + (k5*(static_cast <double> (-2187)/static_cast <double> (6784))) + (k6*(static_cast <double> (11)/static_cast <double> (84)));  
+template <class T> earthStage<T>::earthStage(const T & stepSize, stageCache<T> & cache) : stepSize(stepSize), cache(cache), stage(0) {
+}
 
-    // Error 
-    // See the original algorithm by J.R. Dormand and P.J. Prince, JCAM 1980 and its implementation in MATLAB's ode45
-    // Dormand-Prince : no error between GPU and CPU
-    //y_prev = k1*5179./57600 + k3*7571./16695 + k4*393./640 - k5*92097./339200 + k6*187./2100 + k7*1./40;  
-    //error = y_new-y_prev;
+template <class T> void earthStage<T>::operator()(const double &, const elements<T> & y, elements<T> & k) {
+    // Earth's derivative depends only on its value, so k1 can be k7 of the step before if that step ended here
+    elements<T> rate;
+    if (stage == 0 && cache.rateSet && y == cache.rateY) {
+        rate = cache.rate;
+    }
+    else {
+        rate = calc_gravityRate(y);
+    }
+    if (stage == dormandPrince5Tableau::stages - 1) {
+        cache.rateY = y;
+        cache.rate = rate;
+        cache.rateSet = true;
+    }
+    stage++;
 
-    error = (k1*(static_cast <double> (71)/static_cast <double> (57600))) + (k3*(static_cast <double> (-71)/static_cast <double> (16695))) + (k4*(static_cast <double> (71)/static_cast <double> (1920))) - (k5*(static_cast <double> (17253)/static_cast <double> (339200))) + (k6*(static_cast <double> (22)/static_cast <double> (525))) + (k7*(static_cast <double> (-1)/static_cast <double> (40)));    
+    k = rate*stepSize;
+}
+
+template <class T> elements<T> rkDenseOutput(const elements<T> & y0, const elements<T> * stages, const T & theta) {
+    // Weights of each k as polynomials in theta, from the BI matrix of MATLAB's ntrp45
+    // b_i(theta) = BI[i][0]*theta + BI[i][1]*theta^2 + BI[i][2]*theta^3 + BI[i][3]*theta^4, k2 has no weight
+    T theta2 = theta*theta;
+    T theta3 = theta2*theta;
+    T theta4 = theta3*theta;
+
+    T b1 = theta + (static_cast <double> (-183)/static_cast <double> (64))*theta2 + (static_cast <double> (37)/static_cast <double> (12))*theta3 + (static_cast <double> (-145)/static_cast <double> (128))*theta4;
+    T b3 = (static_cast <double> (1500)/static_cast <double> (371))*theta2 + (static_cast <double> (-1000)/static_cast <double> (159))*theta3 + (static_cast <double> (1000)/static_cast <double> (371))*theta4;
+    T b4 = (static_cast <double> (-125)/static_cast <double> (32))*theta2 + (static_cast <double> (125)/static_cast <double> (12))*theta3 + (static_cast <double> (-375)/static_cast <double> (64))*theta4;
+    T b5 = (static_cast <double> (9477)/static_cast <double> (3392))*theta2 + (static_cast <double> (-729)/static_cast <double> (106))*theta3 + (static_cast <double> (25515)/static_cast <double> (6784))*theta4;
+    T b6 = (static_cast <double> (-11)/static_cast <double> (7))*theta2 + (static_cast <double> (11)/static_cast <double> (3))*theta3 + (static_cast <double> (-55)/static_cast <double> (28))*theta4;
+    T b7 = (static_cast <double> (3)/static_cast <double> (2))*theta2 + (static_cast <double> (-4))*theta3 + (static_cast <double> (5)/static_cast <double> (2))*theta4;
+
+    return y0 + stages[0]*b1 + stages[2]*b3 + stages[3]*b4 + stages[4]*b5 + stages[5]*b6 + stages[6]*b7;
 }
 
 template <class T> __host__ __device__ T calc_scalingFactor(const elements<T> & previous , const elements<T> & difference, const T & absTol, const double precThresh) {
@@ -264,6 +421,37 @@ template <class T> __host__ __device__ T calc_scalingFactor(const elements<T> &
     return scale;   
 }
 
+template <class T> __host__ __device__ T calc_errorNorm(const elements<T> & previous, const elements<T> & current, const elements<T> & difference, const T & absTol) {
+    T distance = fmax(sqrt(previous.r*previous.r + previous.z*previous.z), sqrt(current.r*current.r + current.z*current.z));
+    T speed = fmax(sqrt(previous.vr*previous.vr + previous.vtheta*previous.vtheta + previous.vz*previous.vz),
+                   sqrt(current.vr*current.vr + current.vtheta*current.vtheta + current.vz*current.vz));
+
+    T sum = pow(difference.r/distance, 2) + pow(difference.theta, 2) + pow(difference.z/distance, 2)
+          + pow(difference.vr/speed, 2) + pow(difference.vtheta/speed, 2) + pow(difference.vz/speed, 2);
+    return sqrt(sum/6)/absTol;
+}
+
+template <class T> __host__ __device__ T calc_piStep(const T & stepSize, const T & errNorm, T & errPrev, bool & rejected, const int & errorOrder) {
+    const T beta = 0.04;              // weight of the previous error, the I part is 1/(errorOrder+1) - 0.75 beta
+    const T expo = static_cast<T>(1)/(errorOrder+1) - 0.75*beta;
+    const T safety = 0.9;
+    const T facMin = 0.2, facMax = 10; // the step changes by at least 1/5 and at most 10 times
+
+    T errFactor = pow(errNorm, expo);
+    if (errNorm <= 1) {
+        T factor = fmax(1/facMax, fmin(1/facMin, errFactor/pow(errPrev, beta)/safety));
+        T nextStep = stepSize/factor;
+        if (rejected) {
+            nextStep = fmin(nextStep, stepSize);
+        }
+        errPrev = fmax(errNorm, static_cast<T>(1e-4));
+        rejected = false;
+        return nextStep;
+    }
+    rejected = true;
+    return stepSize/fmin(1/facMin, errFactor/safety);
+}
+
 template <class T> __host__ __device__ bool pmLimitCheck(const elements<T> & pmError, const double precThresh){
     //It is possible this is a major resource drain. This might be faster to square everything and not use fabs (floating point abs)
     if( (fabs(pmError.r) < precThresh ) ||
@@ -2,6 +2,11 @@
 #define RUNGE_KUTTA_H
 #include "../Thrust_Files/coefficients.h"
 #include "../Thrust_Files/thruster.h" // used to pass in a thruster type
+#include "../Thrust_Files/calcFourier.h" // for thrustAngles
+#include "../Motion_Eqns/motion_equations.h" // for calc_k()
+#include "../Thrust_Files/thrustTable.h" // for thrustTable, an alternative to coefficients in rkCalc()
+#include "../Motion_Eqns/kepler.h" // for keplerPropagate(), used by keplerCoast()
+#include "rkTableau.h" // for rkTableauStep(), the Runge-Kutta engine rkCalc() and rkCalcEarth() use
 
 
 // Three variations of fifth-order Runge-Kutta algorthim for system of ODEs defined in ODE45.h
@@ -33,7 +38,7 @@
     //      accel_output: an array which contains all accel values for a given run
     //      fuelSpent: output array to hold the aggregate fuel spent at each time step
     // Output: A dynamic array of position and velocity sets, last entry is final conditions
-    //Called by trajectoryPrint()
+    // ** Currently not used **, trajectoryPrint() samples a DenseTrajectory (denseTrajectory.h) instead
 template <class T> void rk4sys(const T & timeInitial, const T & timeFinal, T *times, const elements<T> & y0, T stepSize, elements<T> *y_new, 
                                 const T & absTol, coefficients<T> coeff, T *gamma,  T *tau, int & lastStep, T *accel_output, T *fuelSpent, const T & wetMass, const cudaConstants* cConstant);
 
@@ -52,15 +57,110 @@ template <class T> void rk4Reverse(const T & timeInitial, const T & timeFinal, c
 
 
 
-// calculates k values 1 - 7 from equation and uses k values to find current and previous values of y
-// error = y_new - y_prev, calculated analytically using k values
-// error used in calc_scalingFactor
-template <class T> __host__ __device__ void rkCalc(T & curTime, const T & timeFinal, T stepSize, elements<T> & y_new, coefficients<T> & coeff, const T & accel, 
-                                                    elements<T> & error);
-
+// What one stage of rkCalc() or rkCalcEarth() found that a later one can use again
+// Kept by the caller across the steps of a trajectory so a tableau that is first same as last (Tab::fsal, as Dormand-Prince 5(4))
+// starts each step with the last stage of the step before, its value and time are where the next step starts
+// Only the sun's gravity (calc_gravityRate()) and the thrust angles are kept, the thrust acceleration changes from step to step
+// so it is added again for each stage. Both are found again whenever the value or time differs, so a step after a rejected step,
+// a Kepler jump, or a different trajectory simply finds its first stage again
+template <class T> struct stageCache {
+    bool rateSet;        // if rate has been found yet
+    elements<T> rateY;   // value rate was found at
+    elements<T> rate;    // calc_gravityRate() at rateY
+    bool anglesSet;      // if angles have been found yet
+    T angleTime;         // time of angles (s)
+    bool angleCoast;     // if angles were found with no thrust, calc_stageAngles() leaves them at 0
+    thrustAngles<T> angles;
 
+    __host__ __device__ stageCache();
+};
 
-template <class T> void rkCalcEarth(T & curTime, const T & timeFinal, T stepSize, elements<T> & y_new, elements<T> & error);
+// calculates the k values of the Runge-Kutta pair tableau (a cudaConstants::RK_TABLEAU value, rk_tableau in the config) from equation
+// and uses k values to find current and previous values of y
+// error = y_new - y_prev, calculated analytically using k values
+// error used in calc_scalingFactor
+// profile is where the thrust angles come from, either the individual's coefficients<T> or a thrustTable<T> built from them
+// cache carries the last stage of a step to the first of the next (see stageCache), nullptr to find every stage
+// If stages is not nullptr, the k values of the step are copied into it (room for the tableau's stages, k1 - k7 of DP5 for rkDenseOutput())
+// mu is the sun's gravitational parameter in the units of the step, 1 with canonical_units (see toTimeUnit())
+template <class T, class P> __host__ __device__ void rkCalc(T & curTime, const T & timeFinal, T stepSize, elements<T> & y_new, P & profile, const T & accel, 
+                                                    elements<T> & error, const int & tableau = cudaConstants::DP5_TABLEAU, stageCache<T> * cache = nullptr,
+                                                    elements<T> * stages = nullptr, const T & mu = constG * massSun);
+
+// rkCalc() for the tableau Tab (see rkTableau.h)
+template <class Tab, class T, class P> __host__ __device__ void rkCalcTableau(const T & curTime, const T & timeFinal, const T & stepSize, elements<T> & y_new, P & profile, const T & accel, 
+                                                                     elements<T> & error, stageCache<T> & cache, elements<T> * stages, const T & mu);
+
+// Stage of rkCalc() for rkTableauStep(), sets k to the step size times the spacecraft's derivative at curTime + c*stepSize
+// The thrust angles of the last stage are kept, so a stage at the same time as the one before (the last two of DP5) reuses them
+// With keepLast the gravity of the last stage is kept in cache for the first stage of the next step
+template <class T, class P> struct thrustStage {
+    const T & curTime;
+    const T & stepSize;
+    const T & timeFinal;
+    const T & accel;
+    const T & mu;  // sun's gravitational parameter, passed to calc_gravityRate()
+    P & profile;
+    stageCache<T> & cache;
+    int stage;     // index of the next stage
+    int lastStage; // index of the stage kept in cache, -1 for none
+
+    __host__ __device__ thrustStage(const T & curTime, const T & stepSize, const T & timeFinal, P & profile, const T & accel, stageCache<T> & cache, const bool & keepLast, const int & stages, const T & mu);
+    __host__ __device__ void operator()(const double & c, const elements<T> & y, elements<T> & k);
+};
+
+
+
+// Time the coast state changes between two times, found by bisection on calc_coast() as it depends only on time
+// Input: profile, thrust - as for calc_coast()
+//        t0, t1 - times the coast state is known to differ between (s), thrustAtT0 - calc_coast() at t0
+//        timeFinal - end of the trip (s), the switch is found to within 1e-12 of it
+// Output: returns the earliest time found past the switch, where calc_coast() is no longer thrustAtT0 (t1 at most)
+template <class T, class P> __host__ __device__ T coastSwitchTime(P & profile, const T & t0, const T & t1, const T & timeFinal, thruster<T> & thrust, bool thrustAtT0);
+
+// Jumps over a coast arc with keplerPropagate() in place of rkCalc(), used when kepler_coast is true
+// With no thrust the motion is two body (sun only), so the arc is closed form and needs no force evaluations
+// The steps rk4SimpleIndividual() would take are walked, only evaluating the coast state at the start of each, so thrust
+// comes back on at the same time as when stepping through the arc (the step size is held, the arc has no error to adjust it by)
+// With step_control=PI the arc ends at the switch found by coastSwitchTime(), as steps of rk4ControlledIndividual() do
+// Input: curTime - time at the start of the arc, where the thrust is off (s)
+//        startTime, timeFinal - start and end of the trip, for the step size limits (s)
+//        stepSize - step size at the start of the arc (s)
+//        y - position and velocity at the start of the arc
+//        profile, thrust - where the coast state comes from, as for calc_coast()
+//        massFuelSpent - fuel used so far (kg), if it is all used the arc lasts until timeFinal
+//        cConstant - thruster_type, fuel_mass, min_numsteps and max_numsteps
+//        mu - sun's gravitational parameter in the units of y and the times (1 with canonical_units)
+// Output: returns false and changes nothing if the orbit comes within 0.5 AU of the sun (the arc is left to rkCalc() so that is
+//         caught where rk4SimpleIndividual() checks for it), otherwise returns true with curTime at the end of the arc (where thrust
+//         comes back on or timeFinal), y the position and velocity there, and stepSize the step size to continue with
+template <class T, class P> __host__ __device__ bool keplerCoast(T & curTime, const T & startTime, const T & timeFinal, T & stepSize, elements<T> & y, P & profile,
+                                                             thruster<T> & thrust, const T & massFuelSpent, const cudaConstants* cConstant, const T & mu = constG * massSun);
+
+// Earth version of rkCalc (no thrust), stepping backwards in time by stepSize
+// Always Dormand-Prince 5(4), as rkDenseOutput() is that pair's continuous extension
+// If stages is not nullptr, k1 - k7 of the step are copied into stages[0] - stages[6] for use with rkDenseOutput()
+// cache carries k7 of a step to k1 of the next as in rkCalc(), nullptr to find every stage
+// curTime and timeFinal are not used, Earth's derivative only depends on its value
+template <class T> void rkCalcEarth(T & curTime, const T & timeFinal, T stepSize, elements<T> & y_new, elements<T> & error, elements<T> * stages = nullptr, stageCache<T> * cache = nullptr);
+
+// Stage of rkCalcEarth() for rkTableauStep(), sets k to the step size times Earth's derivative (calc_gravityRate()) at y
+// The last stage is kept in cache for the first stage of the next step, as in thrustStage
+template <class T> struct earthStage {
+    const T & stepSize;
+    stageCache<T> & cache;
+    int stage; // index of the next stage
+
+    earthStage(const T & stepSize, stageCache<T> & cache);
+    void operator()(const double & c, const elements<T> & y, elements<T> & k);
+};
+
+// Dormand-Prince dense output (the continuous extension used by MATLAB's ode45 in ntrp45), the value part way through a step
+// Input: y0 - value at the start of the step
+//        stages - k1 - k7 of the step from rkCalcEarth() or rkCalc() with DP5 (which include the step size)
+//        theta - fraction of the step (0 is the start and 1 is the end of the step)
+// Output: returns the fourth order interpolated value at theta, at theta = 1 it equals the step's result
+template <class T> elements<T> rkDenseOutput(const elements<T> & y0, const elements<T> * stages, const T & theta);
 
 
 /**********************************************************************************************************************************/
@@ -82,5 +182,20 @@ template <class T> __host__ __device__ T calc_scalingFactor(const elements<T> &
 // This is used to determine if the return of calc_scaling_factor should be calculated
 template <class T> __host__ __device__ bool pmLimitCheck(const elements<T> & pmError, const double precThresh);
 
+// Size of a step's error for step_control=PI, relative to absTol (the step is accepted if this is at most 1)
+// Position errors are taken relative to the distance from the sun, theta's in radians (so r*theta is too), and velocity errors
+// relative to the speed, the larger of the two ends of the step in each case, then combined as a root mean square
+// Input: previous, current - value at the start and end of the step, difference - error from rkCalc(), absTol - rk_tol
+// Output: root mean square of the relative errors over absTol
+template <class T> __host__ __device__ T calc_errorNorm(const elements<T> & previous, const elements<T> & current, const elements<T> & difference, const T & absTol);
+
+// PI step size controller for step_control=PI (Hairer, Norsett and Wanner, Solving ODEs I, section IV.2, as in their DOPRI5)
+// Input: stepSize - size of the step just taken (s), errNorm - its calc_errorNorm()
+//        errPrev - errNorm of the last accepted step (1e-4 before the first), rejected - if the last step was rejected (false before the first)
+//        errorOrder - order of the error estimate, from tableauErrorOrder() (4 for Dormand-Prince 5(4))
+// Output: returns the step size to take next, the retry of this step if errNorm is above 1 or the next step if not
+//         errPrev and rejected are updated for the next call, after a rejection the step after the retry cannot grow
+template <class T> __host__ __device__ T calc_piStep(const T & stepSize, const T & errNorm, T & errPrev, bool & rejected, const int & errorOrder);
+
 #include "runge_kutta.cpp"
 #endif
\ No newline at end of file
@@ -0,0 +1,393 @@
+#include <math.h> // for sqrt, pow, sin and cos
+
+void elementsBatch::setLane(int l, const elements<double> & e) {
+    r[l] = e.r;
+    theta[l] = e.theta;
+    z[l] = e.z;
+    vr[l] = e.vr;
+    vtheta[l] = e.vtheta;
+    vz[l] = e.vz;
+}
+
+elements<double> elementsBatch::getLane(int l) const {
+    return elements<double>(r[l], theta[l], z[l], vr[l], vtheta[l], vz[l]);
+}
+
+void addScaled(elementsBatch & out, const elementsBatch & k, const double & a) {
+    for (int l = 0; l < RK_BATCH_LANES; l++) {
+        out.r[l] += k.r[l]*a;
+        out.theta[l] += k.theta[l]*a;
+        out.z[l] += k.z[l]*a;
+        out.vr[l] += k.vr[l]*a;
+        out.vtheta[l] += k.vtheta[l]*a;
+        out.vz[l] += k.vz[l]*a;
+    }
+}
+
+void blendError(elementsBatch & error, const elementsBatch & lowError) {
+    for (int l = 0; l < RK_BATCH_LANES; l++) {
+        error.r[l] = blendErrorComponent(error.r[l], lowError.r[l]);
+        error.theta[l] = blendErrorComponent(error.theta[l], lowError.theta[l]);
+        error.z[l] = blendErrorComponent(error.z[l], lowError.z[l]);
+        error.vr[l] = blendErrorComponent(error.vr[l], lowError.vr[l]);
+        error.vtheta[l] = blendErrorComponent(error.vtheta[l], lowError.vtheta[l]);
+        error.vz[l] = blendErrorComponent(error.vz[l], lowError.vz[l]);
+    }
+}
+
+void calc_gravityRateBatch(const elementsBatch & y, elementsBatch & rate, const double & mu) {
+    for (int l = 0; l < RK_BATCH_LANES; l++) {
+        double radius2 = y.r[l]*y.r[l] + y.z[l]*y.z[l];
+        double gravity = -mu / (radius2*sqrt(radius2)); // -GM/|r|^3
+
+        rate.r[l] = y.vr[l];
+        rate.theta[l] = y.vtheta[l] / y.r[l];
+        rate.z[l] = y.vz[l];
+        rate.vr[l] = gravity*y.r[l] + y.vtheta[l]*y.vtheta[l] / y.r[l];
+        rate.vtheta[l] = -y.vr[l]*y.vtheta[l] / y.r[l];
+        rate.vz[l] = gravity*y.z[l];
+    }
+}
+
+void calc_kFromRateBatch(const double h[], const elementsBatch & rate, const double accel[], const double dirR[], const double dirTheta[], const double dirZ[], elementsBatch & k) {
+    for (int l = 0; l < RK_BATCH_LANES; l++) {
+        k.r[l] = h[l]*rate.r[l];
+        k.theta[l] = h[l]*rate.theta[l];
+        k.z[l] = h[l]*rate.z[l];
+        k.vr[l] = h[l]*(rate.vr[l] + accel[l]*dirR[l]);
+        k.vtheta[l] = h[l]*(rate.vtheta[l] + accel[l]*dirTheta[l]);
+        k.vz[l] = h[l]*(rate.vz[l] + accel[l]*dirZ[l]);
+    }
+}
+
+void calc_kBatch(const double h[], const elementsBatch & y, const double accel[], const double dirR[], const double dirTheta[], const double dirZ[], elementsBatch & k, const double & mu) {
+    for (int l = 0; l < RK_BATCH_LANES; l++) {
+        double radius2 = y.r[l]*y.r[l] + y.z[l]*y.z[l];
+        double gravity = -mu / (radius2*sqrt(radius2)); // -GM/|r|^3
+
+        k.r[l] = h[l]*y.vr[l];
+        k.theta[l] = h[l]*(y.vtheta[l] / y.r[l]);
+        k.z[l] = h[l]*y.vz[l];
+        k.vr[l] = h[l]*(gravity*y.r[l] + y.vtheta[l]*y.vtheta[l] / y.r[l] + accel[l]*dirR[l]);
+        k.vtheta[l] = h[l]*(-y.vr[l]*y.vtheta[l] / y.r[l] + accel[l]*dirTheta[l]);
+        k.vz[l] = h[l]*(gravity*y.z[l] + accel[l]*dirZ[l]);
+    }
+}
+
+// Thrust direction of each lane in use at stage time curTime + c*h, lanes that are coasting or empty get 0
+// Found per lane as each lane has its own coefficients (or thrust table when useTable is true) and time
+// dirTime is the time each lane's direction was found at (NAN for none), a lane still at that time keeps its direction, so
+// stages at the same time (k6 and k7 of DP5, or the first stage of a step after the last of the step before) find it once
+void calc_dirBatch(coefficients<double> *coeff[], const thrustTable<double> *tables, const bool useTable[], const double curTime[], const double h[], const double & c,
+                   const double tripTime[], const double accel[], double dirR[], double dirTheta[], double dirZ[], double dirTime[]) {
+    for (int l = 0; l < RK_BATCH_LANES; l++) {
+        double stageTime = curTime[l] + c*h[l];
+        if (accel[l] == 0) {
+            dirR[l] = dirTheta[l] = dirZ[l] = 0;
+            dirTime[l] = NAN;
+        }
+        else if (stageTime != dirTime[l]) {
+            thrustAngles<double> angles;
+            if (useTable[l]) {
+                angles = calc_thrustAngles(tables[l], stageTime, tripTime[l]);
+            }
+            else {
+                angles = calc_thrustAngles(*coeff[l], stageTime, tripTime[l]);
+            }
+            dirR[l] = angles.cosTau*angles.sinGamma;
+            dirTheta[l] = angles.cosTau*angles.cosGamma;
+            dirZ[l] = angles.sinTau;
+            dirTime[l] = stageTime;
+        }
+    }
+}
+
+void rk4SimpleBatch(Individual *individuals, int count, const double & timeInitial, const double & startStepSize, const double & absTol, const cudaConstants* cConstant, thrustTable<double> *tables, const pruneBounds *prune, int *tableFallbacks) {
+    if (cConstant->rk_tableau == cudaConstants::DOP853_TABLEAU) {
+        rk4TableauBatch<dop853Tableau>(individuals, count, timeInitial, startStepSize, absTol, cConstant, tables, prune, tableFallbacks);
+    }
+    else if (cConstant->rk_tableau == cudaConstants::VERNER65_TABLEAU) {
+        rk4TableauBatch<verner65Tableau>(individuals, count, timeInitial, startStepSize, absTol, cConstant, tables, prune, tableFallbacks);
+    }
+    else {
+        rk4TableauBatch<dormandPrince5Tableau>(individuals, count, timeInitial, startStepSize, absTol, cConstant, tables, prune, tableFallbacks);
+    }
+}
+
+template <class Tab> void rk4TableauBatch(Individual *individuals, int count, const double & timeInitial, const double & startStepSize, const double & absTol, const cudaConstants* cConstant, thrustTable<double> *tables, const pruneBounds *prune, int *tableFallbacks) {
+    thruster<double> thrust(cConstant);
+
+    elementsBatch y, yStart, error;
+    elementsBatch k[Tab::stages];
+
+    // Per lane state
+    int laneIndex[RK_BATCH_LANES];   // index into individuals of the trajectory in this lane, -1 if the lane is empty
+    coefficients<double> *coeff[RK_BATCH_LANES];
+    double curTime[RK_BATCH_LANES], stepSize[RK_BATCH_LANES], tripTime[RK_BATCH_LANES];
+    double massFuelSpent[RK_BATCH_LANES];
+    double stepFuelSpent[RK_BATCH_LANES]; // massFuelSpent if this step is kept
+    double accel[RK_BATCH_LANES];
+    double h[RK_BATCH_LANES];        // step size used this step, 0 for empty lanes so they stay where they are
+    double dirR[RK_BATCH_LANES], dirTheta[RK_BATCH_LANES], dirZ[RK_BATCH_LANES];
+    double dirTime[RK_BATCH_LANES];  // time the thrust direction was found at, see calc_dirBatch()
+    // First same as last, the sun's gravity at the start of each lane's step when carried is true (found as the last stage
+    // of the lane's last accepted step), and the last stage of this step
+    elementsBatch fsalRate = elementsBatch(), lastRate = elementsBatch();
+    bool carried[RK_BATCH_LANES];
+    const int lastStage = (Tab::fsal && cConstant->carry_stage) ? Tab::stages - 1 : -1; // carry_stage=false is for timing without it
+    double pruneInterval[RK_BATCH_LANES], nextPrune[RK_BATCH_LANES]; // checkpoints of each lane, as in rk4SimpleIndividual()
+    bool pruning = (prune != nullptr && prune->checkpoints > 0);
+    bool controlled = (cConstant->step_control == cudaConstants::PI_STEP);
+    const int errorOrder = Tab::errorOrder;
+    double plannedStep[RK_BATCH_LANES];            // step size before being shortened to a thrust switch, for step_control=PI
+    double errPrev[RK_BATCH_LANES];                // PI controller state of each lane, as in rk4ControlledIndividual()
+    bool rejected[RK_BATCH_LANES];
+
+    // Units the lanes are integrated in, canonical units with canonical_units as in rk4SimpleIndividual()
+    const double timeUnit = cConstant->canonical_units ? canonicalTime : 1;
+    const double mu = cConstant->canonical_units ? 1 : constG * massSun;
+    const double startTime = timeInitial / timeUnit;
+
+    // Thrust table of each lane, used in place of the coefficients when thrust_table_tol is set and the table meets it
+    // Too large for the stack, so only allocated when tables are used and the caller did not pass any in
+    bool ownTables = false;
+    bool useTable[RK_BATCH_LANES];
+    if (cConstant->thrust_table_tol > 0 && tables == nullptr) {
+        tables = new thrustTable<double>[RK_BATCH_LANES];
+        ownTables = true;
+    }
+
+    // Empty lanes hold a harmless position (1 AU, at rest) so their derivatives stay finite
+    elements<double> idle(1, 0, 0, 0, 0, 0);
+
+    int next = 0;   // next individual to load into a lane
+    int active = 0; // number of lanes in use
+
+    // Loads the next individual into lane l, or marks it empty if there are none left
+    auto loadLane = [&](int l) {
+        if (next < count) {
+            laneIndex[l] = next;
+            coeff[l] = &individuals[next].startParams.coeff;
+            tripTime[l] = individuals[next].startParams.tripTime / timeUnit;
+            curTime[l] = startTime;
+            stepSize[l] = startStepSize / timeUnit;
+            if (controlled) {
+                stepSize[l] = fmin(fmax(stepSize[l], (tripTime[l] - startTime) / cConstant->max_numsteps), (tripTime[l] - startTime) / cConstant->min_numsteps);
+            }
+            massFuelSpent[l] = 0;
+            errPrev[l] = 1e-4;
+            rejected[l] = false;
+            pruneInterval[l] = pruning ? (tripTime[l] - startTime) / (prune->checkpoints + 1) : 0;
+            nextPrune[l] = startTime + pruneInterval[l];
+            individuals[next].prunedTime = 0;
+            useTable[l] = cConstant->thrust_table_tol > 0 && initThrustTable(tables[l], *coeff[l], cConstant->thrust_table_tol);
+            if (cConstant->thrust_table_tol > 0 && !useTable[l] && tableFallbacks != nullptr) {
+                (*tableFallbacks)++;
+            }
+            y.setLane(l, toTimeUnit(individuals[next].startParams.y0, timeUnit));
+            carried[l] = false;
+            dirTime[l] = NAN;
+            next++;
+            active++;
+        }
+        else {
+            laneIndex[l] = -1;
+            coeff[l] = nullptr;
+            tripTime[l] = curTime[l] = stepSize[l] = massFuelSpent[l] = 0;
+            errPrev[l] = 1e-4;
+            rejected[l] = false;
+            pruneInterval[l] = nextPrune[l] = 0;
+            useTable[l] = false;
+            y.setLane(l, idle);
+            carried[l] = false;
+            dirTime[l] = NAN;
+        }
+    };
+
+    for (int l = 0; l < RK_BATCH_LANES; l++) {
+        loadLane(l);
+    }
+
+    // Coast state of lane l at time t
+    auto laneCoast = [&](int l, double t) {
+        return useTable[l] ? calc_coast(tables[l], t, tripTime[l], thrust) : calc_coast(*coeff[l], t, tripTime[l], thrust);
+    };
+
+    // Sets up lane l's step from its current time, its thrust acceleration and the fuel it spends
+    // With step_control=PI the step is shortened to end at the trip's end or a thrust switch, as in rk4ControlledIndividual()
+    auto prepareLane = [&](int l) {
+        stepFuelSpent[l] = massFuelSpent[l];
+        if (laneIndex[l] < 0) {
+            accel[l] = 0;
+            return;
+        }
+        if (controlled) {
+            if ( (curTime[l] + stepSize[l]) > tripTime[l]) {
+                stepSize[l] = (tripTime[l] - curTime[l]);
+            }
+            plannedStep[l] = stepSize[l];
+        }
+        if (cConstant->thruster_type == thruster<double>::NO_THRUST) {
+            accel[l] = 0;
+            return;
+        }
+        bool coast = laneCoast(l, curTime[l]);
+        if (controlled && laneCoast(l, curTime[l] + stepSize[l]) != coast) {
+            double switchTime = useTable[l] ? coastSwitchTime(tables[l], curTime[l], curTime[l] + stepSize[l], tripTime[l], thrust, coast)
+                                            : coastSwitchTime(*coeff[l], curTime[l], curTime[l] + stepSize[l], tripTime[l], thrust, coast);
+            stepSize[l] = switchTime - curTime[l];
+        }
+        accel[l] = calc_accel(y.r[l], y.z[l], thrust, stepFuelSpent[l], stepSize[l]*timeUnit, coast, static_cast<double>(cConstant->wet_mass), cConstant) * timeUnit*timeUnit;
+    };
+
+    while (active > 0) {
+        // Thrust acceleration of each lane for this step
+        for (int l = 0; l < RK_BATCH_LANES; l++) {
+            prepareLane(l);
+
+            // Lanes that are coasting jump to where the thrust comes back on with keplerCoast(), as in rk4SimpleIndividual(),
+            // and take this step from there (a lane whose trip ended in the arc has a step size of 0 and finishes below)
+            if (cConstant->kepler_coast && laneIndex[l] >= 0 && accel[l] == 0) {
+                elements<double> curPos = y.getLane(l);
+                double arcStep = controlled ? plannedStep[l] : stepSize[l];
+                bool jumped = useTable[l] ? keplerCoast(curTime[l], startTime, tripTime[l], arcStep, curPos, tables[l], thrust, massFuelSpent[l], cConstant, mu)
+                                          : keplerCoast(curTime[l], startTime, tripTime[l], arcStep, curPos, *coeff[l], thrust, massFuelSpent[l], cConstant, mu);
+                if (jumped) {
+                    y.setLane(l, curPos);
+                    carried[l] = false;
+                    stepSize[l] = arcStep;
+                    if (curTime[l] < tripTime[l]) {
+                        prepareLane(l);
+                    }
+                    else {
+                        stepSize[l] = 0;
+                        accel[l] = 0;
+                    }
+                }
+            }
+            h[l] = (laneIndex[l] < 0) ? 0 : stepSize[l];
+        }
+        yStart = y;
+
+        // The first stage starts from the carried gravity when every lane has it, a lane without it (just loaded, after a
+        // Kepler jump) has the whole batch find it again for this step
+        bool allCarried = true;
+        for (int l = 0; l < RK_BATCH_LANES; l++) {
+            allCarried = allCarried && carried[l];
+        }
+
+        // calculate k values for every lane with rkTableauStep(), see rkCalc()
+        // The thrust directions are only found again for lanes at a different time than the last stage
+        int stageIndex = 0;
+        auto stage = [&](const double & c, const elementsBatch & yStage, elementsBatch & kStage) {
+            calc_dirBatch(coeff, tables, useTable, curTime, h, c, tripTime, accel, dirR, dirTheta, dirZ, dirTime);
+            if (stageIndex == 0 && allCarried) {
+                calc_kFromRateBatch(h, fsalRate, accel, dirR, dirTheta, dirZ, kStage);
+            }
+            else if (stageIndex == lastStage) {
+                calc_gravityRateBatch(yStage, lastRate, mu);
+                calc_kFromRateBatch(h, lastRate, accel, dirR, dirTheta, dirZ, kStage);
+            }
+            else {
+                calc_kBatch(h, yStage, accel, dirR, dirTheta, dirZ, kStage, mu);
+            }
+            stageIndex++;
+        };
+        rkTableauStep<Tab>(y, error, k, stage);
+
+        // Keeps the last stage of lane l for its next step, for a lane that moves on to the end of this step
+        auto carryLane = [&](int l) {
+            if (lastStage >= 0) {
+                fsalRate.setLane(l, lastRate.getLane(l));
+                carried[l] = true;
+            }
+        };
+
+        // Step size control and termination, per lane as in rk4SimpleIndividual()
+        for (int l = 0; l < RK_BATCH_LANES; l++) {
+            if (laneIndex[l] < 0) {
+                carryLane(l); // empty lanes stay at idle, which the last stage was at
+                continue;
+            }
+            Individual & individual = individuals[laneIndex[l]];
+            elements<double> curPos = y.getLane(l);
+            double minStep = (tripTime[l] - startTime) / cConstant->max_numsteps;
+            double maxStep = (tripTime[l] - startTime) / cConstant->min_numsteps;
+
+            if (controlled) {
+                double errNorm = calc_errorNorm(yStart.getLane(l), curPos, error.getLane(l), absTol);
+                double newStep = calc_piStep(stepSize[l], errNorm, errPrev[l], rejected[l], errorOrder);
+
+                // Over the tolerance, the lane goes back to the start of the step to try again with a smaller one
+                if (errNorm > 1 && stepSize[l] > minStep) {
+                    y.setLane(l, yStart.getLane(l));
+                    stepSize[l] = fmax(newStep, minStep);
+                    continue;
+                }
+                carryLane(l);
+
+                curTime[l] += stepSize[l];
+                massFuelSpent[l] = stepFuelSpent[l];
+                if (stepSize[l] < plannedStep[l]) {
+                    newStep = fmax(newStep, plannedStep[l]);
+                }
+                stepSize[l] = fmin(fmax(newStep, minStep), maxStep);
+            }
+            else {
+                curTime[l] += stepSize[l];
+                massFuelSpent[l] = stepFuelSpent[l];
+                carryLane(l);
+
+                stepSize[l] *= calc_scalingFactor(curPos-error.getLane(l), error.getLane(l), absTol, cConstant->doublePrecThresh);
+
+                // The step size cannot exceed the total time divided by min_numsteps and cannot be smaller than the total time divided by max_numsteps
+                if (stepSize[l] > maxStep) {
+                    stepSize[l] = maxStep;
+                }
+                else if (stepSize[l] < minStep) {
+                    stepSize[l] = minStep;
+                }
+
+                if ( (curTime[l] + stepSize[l]) > tripTime[l]) {
+                    stepSize[l] = (tripTime[l] - curTime[l]); // shorten the last step to end exactly at time final
+                }
+            }
+
+            // if the spacecraft is within 0.5 au of the sun, the individual is invalidated as in rk4SimpleIndividual()
+            if ( sqrt(pow(curPos.r,2) + pow(curPos.z,2)) < 0.5) {
+                individual.finalPos.r = nan("");
+                individual.posDiff = nan("");
+                individual.velDiff = nan("");
+
+                active--;
+                loadLane(l);
+            }
+            else if (curTime[l] >= tripTime[l]) {
+                // output to this individual
+                individual.finalPos = fromTimeUnit(curPos, timeUnit);
+
+                // Calculate new values for this individual
+                individual.getPosDiff(cConstant);
+                individual.getVelDiff(cConstant);
+                individual.getCost(cConstant);
+
+                active--;
+                loadLane(l);
+            }
+            else if (pruning && curTime[l] >= nextPrune[l]) {
+                // Stop here if no thrusting from this point on could make it a survivor
+                if (pruneTrajectory(individual, fromTimeUnit(curPos, timeUnit), (tripTime[l] - curTime[l])*timeUnit, massFuelSpent[l], *prune, cConstant)) {
+                    active--;
+                    loadLane(l);
+                }
+                else {
+                    nextPrune[l] += pruneInterval[l];
+                }
+            }
+        }
+    }
+
+    if (ownTables) {
+        delete [] tables;
+    }
+}
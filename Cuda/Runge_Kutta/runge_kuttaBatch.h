@@ -0,0 +1,80 @@
+#ifndef RUNGE_KUTTA_BATCH_H
+#define RUNGE_KUTTA_BATCH_H
+
+// Number of trajectories the batch integrator advances together
+// 4 doubles fill an AVX2 register and 8 fill an AVX-512 register, compile with the host compiler's AVX2/AVX-512 option
+// (such as -Xcompiler /arch:AVX512 or -Xcompiler -mavx512f) so the lane loops below become vector instructions
+#ifndef RK_BATCH_LANES
+#define RK_BATCH_LANES 8
+#endif
+
+// Structure-of-arrays version of elements<double>, holding one value per lane for each component
+// Lane loops over these arrays are what the compiler vectorizes
+struct elementsBatch {
+    // Positions
+    double r[RK_BATCH_LANES];     // AU
+    double theta[RK_BATCH_LANES]; // Radians
+    double z[RK_BATCH_LANES];     // AU
+
+    // Velocities
+    double vr[RK_BATCH_LANES];     // AU/s
+    double vtheta[RK_BATCH_LANES]; // AU/s
+    double vz[RK_BATCH_LANES];     // AU/s
+
+    // Sets lane l to the values of e
+    void setLane(int l, const elements<double> & e);
+
+    // Returns lane l as an elements<double>
+    elements<double> getLane(int l) const;
+};
+
+// Adds k*a onto out for every lane (out = out + k*a)
+void addScaled(elementsBatch & out, const elementsBatch & k, const double & a);
+
+// Batch version of blendError() for DOP853, blends each lane's error with its third order estimate
+void blendError(elementsBatch & error, const elementsBatch & lowError);
+
+// Batch version of calc_k(), calculates k for every lane at once
+// Input: h - step size of each lane (s), 0 for lanes that are not in use so k is 0 and the lane does not move
+//        y - current position and velocity of each lane
+//        accel - thrust acceleration of each lane (au/s^2)
+//        dirR, dirTheta, dirZ - components of the unit thrust direction of each lane (cos(tau)*sin(gamma), cos(tau)*cos(gamma), sin(tau))
+//        mu - the sun's gravitational parameter, as in calc_gravityRate()
+// Output: k holds h times the derivative of y for every lane
+void calc_kBatch(const double h[], const elementsBatch & y, const double accel[], const double dirR[], const double dirTheta[], const double dirZ[], elementsBatch & k, const double & mu = constG * massSun);
+
+// Batch version of calc_gravityRate(), the derivative of y under the sun's gravity alone for every lane, without the step size
+void calc_gravityRateBatch(const elementsBatch & y, elementsBatch & rate, const double & mu = constG * massSun);
+
+// Batch version of calc_kFromRate(), calc_kBatch() from rates found by calc_gravityRateBatch() (same result as calc_kBatch() at their y)
+void calc_kFromRateBatch(const double h[], const elementsBatch & rate, const double accel[], const double dirR[], const double dirTheta[], const double dirZ[], elementsBatch & k);
+
+// Adaptive runge-kutta for a list of individuals, RK_BATCH_LANES at a time in structure-of-arrays form
+// Same algorithm as rk4SimpleIndividual() (the rk_tableau pair through rkTableauStep(), with the same step size control and limits), but each step
+// is done for all lanes together, with the following handled per lane:
+//     - step size and current time, with step_control=PI a lane over the tolerance goes back to the start of its step and
+//       each step ends where the lane's thrust switches, as in rk4ControlledIndividual()
+//     - coast state, fuel spent, and thrust acceleration (scalar calc_coast()/calc_accel() for each lane)
+//     - thrust table, each lane builds one when thrust_table_tol > 0
+//     - coast arcs, a lane jumps over them with keplerCoast() when kepler_coast is true
+//     - with canonical_units, each lane is integrated in canonical units as rk4SimpleIndividual() does (see toTimeUnit())
+//     - first same as last, with a Tab::fsal pair each lane keeps the sun's gravity at the end of its last accepted step (and
+//       its thrust direction if still at that time), the first stage uses them when every lane has one as rkCalc() does with a stageCache
+//     - termination, when a lane reaches its tripTime, goes within 0.5 AU of the sun, or is pruned it is written out and
+//       the next individual in the list is loaded into that lane, so lanes stay busy until the list runs out
+// Results match rk4SimpleIndividual() to rounding, the gravity term uses r*sqrt(r) in place of pow(r,1.5) to be vectorizable
+// Input: individuals - pointer to the first individual to evaluate
+//        count - number of individuals to evaluate
+//        timeInitial, startStepSize, absTol, cConstant - same as rk4SimpleIndividual()
+//        tables - RK_BATCH_LANES thrust tables for the lanes to use when thrust_table_tol > 0, nullptr to allocate them here
+//        prune - same as rk4SimpleIndividual()
+//        tableFallbacks - if not nullptr, counts the individuals whose thrust table could not meet thrust_table_tol (they use the Fourier series)
+// Output: each individual's finalPos, posDiff, velDiff, cost, and prunedTime are assigned as in rk4SimpleIndividual()
+// Called by rkCPUWorker() when cpu_simd_batch is true
+void rk4SimpleBatch(Individual *individuals, int count, const double & timeInitial, const double & startStepSize, const double & absTol, const cudaConstants* cConstant, thrustTable<double> *tables = nullptr, const pruneBounds *prune = nullptr, int *tableFallbacks = nullptr);
+
+// rk4SimpleBatch() for the tableau Tab (see rkTableau.h), which rk4SimpleBatch() calls for rk_tableau
+template <class Tab> void rk4TableauBatch(Individual *individuals, int count, const double & timeInitial, const double & startStepSize, const double & absTol, const cudaConstants* cConstant, thrustTable<double> *tables, const pruneBounds *prune, int *tableFallbacks);
+
+#include "runge_kuttaBatch.cpp"
+#endif
@@ -0,0 +1,82 @@
+#include <chrono> // for timing the evaluation
+
+// Called by optimize() in optimization.cu
+void callRKCPU(const int numThreads, const int, Individual *generation, double timeInitial, double stepSize, double absTol, double & calcPerS, const cudaConstants* cConstant, ScratchArena *arenas, const pruneBounds *prune) {
+    rkCPUJob job;
+    job.generation = generation;
+    job.numIndividuals = numThreads;
+    job.timeInitial = timeInitial;
+    job.stepSize = stepSize;
+    job.absTol = absTol;
+    job.cConstant = cConstant;
+    job.scheduler = rkScheduler;
+    job.arenas = arenas;
+    job.prune = prune;
+
+    // Split the individuals into chunks for the threads to take from
+    rkScheduler->reset(numThreads, cConstant->cpu_chunk_size);
+
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+
+    // Every thread in the pool evaluates its share of the generation, returns once all are done
+    cpuPool->run(rkCPUWorker, &job);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    calcPerS = numThreads / elapsed.count(); // how many times the Runge Kutta algorithm ran per second
+}
+
+void rkCPUWorker(int threadId, int, void* context) {
+    rkCPUJob *job = static_cast<rkCPUJob*>(context);
+
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+
+    // This thread's scratch memory, if there is any
+    ScratchArena *arena = nullptr;
+    if (job->arenas != nullptr) {
+        arena = &job->arenas[threadId];
+        arena->reset();
+    }
+
+    // Thrust tables reused for each individual this thread evaluates, when thrust_table_tol is set
+    // One for rk4SimpleIndividual(), or one for each lane of rk4SimpleBatch()
+    double tableTol = job->cConstant->thrust_table_tol;
+    int tableCount = job->cConstant->cpu_simd_batch ? RK_BATCH_LANES : 1;
+    thrustTable<double> *table = nullptr;
+    if (tableTol > 0) {
+        table = (arena != nullptr) ? arena->take<thrustTable<double>>(tableCount) : new thrustTable<double>[tableCount];
+    }
+
+    // Individuals whose table could not meet thrust_table_tol, they are integrated with the Fourier series
+    int tableFallbacks = 0;
+
+    // Keep taking chunks (from this thread's queue or stolen from another) until all are done
+    int begin, end;
+    while (job->scheduler->nextChunk(threadId, begin, end)) {
+        if (job->cConstant->cpu_simd_batch) {
+            // The whole chunk goes through the lanes of the batch integrator
+            rk4SimpleBatch(job->generation + begin, end - begin, job->timeInitial, job->stepSize, job->absTol, job->cConstant, table, job->prune, &tableFallbacks);
+        }
+        else {
+            for (int i = begin; i < end; i++) {
+                if (tableTol > 0 && initThrustTable(*table, job->generation[i].startParams.coeff, tableTol)) {
+                    rk4SimpleIndividual(job->generation[i], *table, job->timeInitial, job->stepSize, job->absTol, job->cConstant, job->prune);
+                }
+                else {
+                    if (tableTol > 0) {
+                        tableFallbacks++;
+                    }
+                    rk4SimpleIndividual(job->generation[i], job->timeInitial, job->stepSize, job->absTol, job->cConstant, job->prune);
+                }
+            }
+        }
+    }
+
+    if (arena == nullptr) {
+        delete [] table;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    job->scheduler->addBusyTime(threadId, elapsed.count());
+    job->scheduler->addTableFallbacks(threadId, tableFallbacks);
+}
@@ -0,0 +1,52 @@
+#ifndef RUNGE_KUTTA_CPU_H
+#define RUNGE_KUTTA_CPU_H
+
+#include "../Host_Threads/threadPool.h"   // for cpuPool
+#include "../Host_Threads/workStealing.h" // for WorkStealingScheduler
+#include "../Host_Threads/scratchArena.h" // for ScratchArena, holds each thread's thrust tables
+#include "runge_kuttaCUDA.cuh"          // for rk4SimpleIndividual()
+#include "runge_kuttaBatch.h"          // for rk4SimpleBatch()
+
+// CPU version of callRK(), used when rk_backend=CPU in the config file
+// Has the same interface as callRK() so optimize() can call either one
+// Spreads the individuals over the threads of cpuPool in chunks of cpu_chunk_size using rkScheduler's work stealing,
+// as the number of runge kutta steps (and so the time) needed varies between individuals
+// Input: numThreads - number of individuals in generation to evaluate
+//        blockThreads - not used, kept so the interface matches callRK()
+//        generation - pointer to the first individual to evaluate
+//        timeInitial, stepSize, absTol - passed to rk4SimpleIndividual()
+//        cConstant - passed to rk4SimpleIndividual()
+//        arenas - scratch memory for each thread of cpuPool, holds the thrust tables, nullptr to allocate them every call
+//        prune - passed to rk4SimpleIndividual(), nullptr to integrate every trajectory to the end
+// Output: finalPos, posDiff, velDiff, and cost are set for each individual in generation
+//         calcPerS is set to how many individuals were evaluated per second
+// Called by optimize() in optimization.cu
+void callRKCPU(const int numThreads, const int blockThreads, Individual *generation, double timeInitial, double stepSize, double absTol, double & calcPerS, const cudaConstants* cConstant, ScratchArena *arenas = nullptr, const pruneBounds *prune = nullptr);
+
+// Everything a thread needs to evaluate its share of a generation, passed through ThreadPool::run()
+struct rkCPUJob {
+    Individual *generation; // first individual to evaluate
+    int numIndividuals;     // how many individuals are in generation
+    double timeInitial;
+    double stepSize;
+    double absTol;
+    const cudaConstants* cConstant;
+    WorkStealingScheduler *scheduler; // hands out the chunks of individuals to the threads
+    ScratchArena *arenas;             // one per thread, nullptr if the thrust tables are allocated by each thread
+    const pruneBounds *prune;         // cutoffs for pruneTrajectory(), nullptr if there is no pruning
+};
+
+// Task run by each thread of cpuPool in callRKCPU()
+// Input: threadId - passed to the scheduler to get this thread's chunks
+//        numThreads - not used, part of the ThreadPool task interface
+//        context - pointer to the rkCPUJob for this generation
+// Output: chunks of individuals are evaluated with rk4SimpleIndividual() (or rk4SimpleBatch() when cpu_simd_batch is true)
+//         until the scheduler has none left, using a thrustTable for each individual when thrust_table_tol > 0
+void rkCPUWorker(int threadId, int numThreads, void* context);
+
+// Work stealing scheduler used by callRKCPU(), created in main() alongside cpuPool
+// Holds the load balance statistics of the most recent generation (reported by recordLoadBalance() in output.cpp)
+WorkStealingScheduler *rkScheduler = nullptr;
+
+#include "runge_kuttaCPU.cpp"
+#endif
@@ -6,7 +6,7 @@
 #include <random>
 
 // Called by optimize() in optimization.cu
-void callRK(const int numThreads, const int blockThreads, Individual *generation, double timeInitial, double stepSize, double absTol, double & calcPerS, const cudaConstants* cConstant) {
+void callRK(const int numThreads, const int blockThreads, Individual *generation, double timeInitial, double stepSize, double absTol, double & calcPerS, const cudaConstants* cConstant, const pruneBounds *prune) {
     
     cudaEvent_t kernelStart, kernelEnd;
     cudaEventCreate(&kernelStart);
@@ -17,6 +17,7 @@ void callRK(const int numThreads, const int blockThreads, Individual *generation
     double *devStepSize;
     double *devAbsTol;
     cudaConstants *devCConstant;
+    pruneBounds *devPrune = nullptr;
 
     // allocate memory for the parameters passed to the device
     cudaMalloc((void**) &devGeneration, numThreads * sizeof(Individual));
@@ -24,6 +25,9 @@ void callRK(const int numThreads, const int blockThreads, Individual *generation
     cudaMalloc((void**) &devStepSize, sizeof(double));
     cudaMalloc((void**) &devAbsTol, sizeof(double));
     cudaMalloc((void**) &devCConstant, sizeof(cudaConstants));
+    if (prune != nullptr) {
+        cudaMalloc((void**) &devPrune, sizeof(pruneBounds));
+    }
 
     // copy values of parameters passed from host onto device
     cudaMemcpy(devGeneration, generation, numThreads * sizeof(Individual), cudaMemcpyHostToDevice);
@@ -31,11 +35,14 @@ void callRK(const int numThreads, const int blockThreads, Individual *generation
     cudaMemcpy(devStepSize, &stepSize, sizeof(double), cudaMemcpyHostToDevice);
     cudaMemcpy(devAbsTol, &absTol, sizeof(double), cudaMemcpyHostToDevice);
     cudaMemcpy(devCConstant, cConstant, sizeof(cudaConstants), cudaMemcpyHostToDevice);
+    if (prune != nullptr) {
+        cudaMemcpy(devPrune, prune, sizeof(pruneBounds), cudaMemcpyHostToDevice);
+    }
     
 
     // GPU version of rk4Simple()
     cudaEventRecord(kernelStart);
-    rk4SimpleCUDA<<<(numThreads+blockThreads-1)/blockThreads,blockThreads>>>(devGeneration, devTimeInitial, devStepSize, devAbsTol, numThreads, devCConstant);
+    rk4SimpleCUDA<<<(numThreads+blockThreads-1)/blockThreads,blockThreads>>>(devGeneration, devTimeInitial, devStepSize, devAbsTol, numThreads, devCConstant, devPrune);
     cudaEventRecord(kernelEnd);
 
     // copy the result of the kernel onto the host
@@ -47,6 +54,9 @@ void callRK(const int numThreads, const int blockThreads, Individual *generation
     cudaFree(devStepSize);
     cudaFree(devAbsTol);
     cudaFree(devCConstant);
+    if (devPrune != nullptr) {
+        cudaFree(devPrune);
+    }
 
     float kernelT;
     
@@ -58,82 +68,241 @@ void callRK(const int numThreads, const int blockThreads, Individual *generation
 }
 
 // seperate conditions are passed for each thread, but timeInitial, stepSize, and absTol are the same for every thread
-__global__ void rk4SimpleCUDA(Individual *individuals, double *timeInitial, double *startStepSize, double *absTolInput, int n, const cudaConstants* cConstant) {
+__global__ void rk4SimpleCUDA(Individual *individuals, double *timeInitial, double *startStepSize, double *absTolInput, int n, const cudaConstants* cConstant, const pruneBounds *prune) {
     int threadId = threadIdx.x + blockIdx.x * blockDim.x;
     if (threadId < n) {
-        rkParameters<double> threadRKParameters = individuals[threadId].startParams; // get the parameters for this thread
+        rk4SimpleIndividual(individuals[threadId], *timeInitial, *startStepSize, *absTolInput, cConstant, prune);
+    }
+    return;
+}
+
+// Adaptive runge-kutta for a single individual, shared by the GPU kernel and the CPU backend
+__host__ __device__ void rk4SimpleIndividual(Individual & individual, const double & timeInitial, const double & startStepSize, const double & absTol, const cudaConstants* cConstant, const pruneBounds *prune) {
+    coefficients<double> coeff = individual.startParams.coeff; // thrust angles come straight from the Fourier series
+    rk4SimpleIndividual(individual, coeff, timeInitial, startStepSize, absTol, cConstant, prune);
+}
 
-        elements<double> curPos = threadRKParameters.y0; // start with the initial conditions of the spacecraft
+template <class P> __host__ __device__ void rk4SimpleIndividual(Individual & individual, P & profile, const double & timeInitial, const double & startStepSize, const double & absTol, const cudaConstants* cConstant, const pruneBounds *prune) {
+    if (cConstant->step_control == cudaConstants::PI_STEP) {
+        rk4ControlledIndividual(individual, profile, timeInitial, startStepSize, absTol, cConstant, prune);
+        return;
+    }
 
-        // storing copies of the input values
-        double stepSize = *startStepSize;
-        double absTol = *absTolInput;
-        double curTime = *timeInitial;
-        double startTime = *timeInitial;
-        double curAccel = 0;
+    rkParameters<double> threadRKParameters = individual.startParams; // get the parameters for this thread
 
-        thruster<double> thrust(cConstant);
+    // With canonical_units the integration is in canonical units (see toTimeUnit()), converted from the starting conditions
+    // here and back to AU/s where it is checked by pruneTrajectory() or ends, timeUnit is 1 otherwise so nothing changes
+    const double timeUnit = cConstant->canonical_units ? canonicalTime : 1;
+    const double mu = cConstant->canonical_units ? 1 : constG * massSun;
+    const double tripTime = threadRKParameters.tripTime / timeUnit;
 
-        double massFuelSpent = 0; // mass of total fuel expended (kg) starts at 0
+    elements<double> curPos = toTimeUnit(threadRKParameters.y0, timeUnit); // start with the initial conditions of the spacecraft
 
-        bool coast; // to hold the result from calc_coast()
+    // storing copies of the input values
+    double stepSize = startStepSize / timeUnit;
+    double curTime = timeInitial / timeUnit;
+    double startTime = curTime;
+    double curAccel = 0;
 
-        elements<double> error; // holds output of previous value from rkCalc
+    thruster<double> thrust(cConstant);
 
-        while (curTime < threadRKParameters.tripTime) {
+    double massFuelSpent = 0; // mass of total fuel expended (kg) starts at 0
 
-            // Check the thruster type before performing calculations
-            if (cConstant->thruster_type == thruster<double>::NO_THRUST) {
-                coast = curAccel = 0;
-            }
-            else {
-                coast = calc_coast(threadRKParameters.coeff, curTime, threadRKParameters.tripTime, thrust);
-                curAccel = calc_accel(curPos.r, curPos.z, thrust, massFuelSpent, stepSize, coast, static_cast<double>(cConstant->wet_mass), cConstant);
-            }
+    bool coast; // to hold the result from calc_coast()
+
+    elements<double> error; // holds output of previous value from rkCalc
+    stageCache<double> cache; // carries the last stage of each step to the first of the next, unless carry_stage is false
+
+    // Times to check if the trajectory can still be a survivor, evenly spaced so the last is before the end of the trip
+    individual.prunedTime = 0;
+    bool pruning = (prune != nullptr && prune->checkpoints > 0);
+    double pruneInterval = pruning ? (tripTime - startTime) / (prune->checkpoints + 1) : 0;
+    double nextPrune = startTime + pruneInterval;
+
+    while (curTime < tripTime) {
+
+        // Check the thruster type before performing calculations
+        if (cConstant->thruster_type == thruster<double>::NO_THRUST) {
+            coast = curAccel = 0;
+        }
+        else {
+            coast = calc_coast(profile, curTime, tripTime, thrust);
+            // calc_accel() works in seconds, it is given the step in seconds for the fuel spent and its AU/s^2 is changed to the integration's units
+            curAccel = calc_accel(curPos.r, curPos.z, thrust, massFuelSpent, stepSize*timeUnit, coast, static_cast<double>(cConstant->wet_mass), cConstant) * timeUnit*timeUnit;
+        }
+
+        // Jump over the coast arc in closed form, the loop continues from where the thrust comes back on (or the trip ends)
+        if (cConstant->kepler_coast && curAccel == 0 && keplerCoast(curTime, startTime, tripTime, stepSize, curPos, profile, thrust, massFuelSpent, cConstant, mu)) {
+            continue;
+        }
+
+        // calculate k values and get new value of y
+        rkCalc(curTime, tripTime, stepSize, curPos, profile, curAccel, error, cConstant->rk_tableau, cConstant->carry_stage ? &cache : nullptr, static_cast<elements<double>*>(nullptr), mu);
+
+        curTime += stepSize; // update the current time in the simulation
+        
+        stepSize *= calc_scalingFactor(curPos-error,error,absTol, cConstant->doublePrecThresh); // Alter the step size for the next iteration
+
+        // The step size cannot exceed the total time divided by 2 and cannot be smaller than the total time divided by 1000
+        if (stepSize > (tripTime - startTime) / cConstant->min_numsteps) {
+            stepSize = (tripTime - startTime) / cConstant->min_numsteps;
+        }
+        else if (stepSize < (tripTime - startTime) / cConstant->max_numsteps) {
+            stepSize = (tripTime - startTime) / cConstant->max_numsteps;
+        }
+        
+        if ( (curTime + stepSize) > tripTime) {
+            stepSize = (tripTime - curTime); // shorten the last step to end exactly at time final
+        }
 
-            // calculate k values and get new value of y
-            rkCalc(curTime, threadRKParameters.tripTime, stepSize, curPos, threadRKParameters.coeff, curAccel, error); 
+        // if the spacecraft is within 0.5 au of the sun, the radial position of the spacecraft artificially increases to 1000, to force that path to not be used in the optimization.
+        if ( sqrt(pow(curPos.r,2) + pow(curPos.z,2)) < 0.5) {
+            //This is a bad result, needs to be set to be removed
+            // Right after callRK we check for NaN in the elements, then reset individual
+            individual.finalPos.r = nan("");
 
-            curTime += stepSize; // update the current time in the simulation
-            
-            stepSize *= calc_scalingFactor(curPos-error,error,absTol, cConstant->doublePrecThresh); // Alter the step size for the next iteration
+            //Just to make sure invalidating posDiff/velDiff
+            individual.posDiff = nan("");
+            individual.velDiff = nan("");            
+
+            return;
+        }
 
-            // The step size cannot exceed the total time divided by 2 and cannot be smaller than the total time divided by 1000
-            if (stepSize > (threadRKParameters.tripTime - startTime) / cConstant->min_numsteps) {
-                stepSize = (threadRKParameters.tripTime - startTime) / cConstant->min_numsteps;
+        // Stop here if no thrusting from this point on could make it a survivor
+        if (pruning && curTime >= nextPrune && curTime < tripTime) {
+            if (pruneTrajectory(individual, fromTimeUnit(curPos, timeUnit), (tripTime - curTime)*timeUnit, massFuelSpent, *prune, cConstant)) {
+                return;
             }
-            else if (stepSize < (threadRKParameters.tripTime - startTime) / cConstant->max_numsteps) {
-                stepSize = (threadRKParameters.tripTime - startTime) / cConstant->max_numsteps;
+            nextPrune += pruneInterval;
+        }
+    }
+
+    // output to this individual
+    individual.finalPos = fromTimeUnit(curPos, timeUnit);
+
+    // Calculate new values for this individual
+    individual.getPosDiff(cConstant);
+    individual.getVelDiff(cConstant);
+    individual.getCost(cConstant);
+
+    return;
+}
+
+template <class P> __host__ __device__ void rk4ControlledIndividual(Individual & individual, P & profile, const double & timeInitial, const double & startStepSize, const double & absTol, const cudaConstants* cConstant, const pruneBounds *prune) {
+    rkParameters<double> threadRKParameters = individual.startParams; // get the parameters for this thread
+
+    // Units of the integration, as in rk4SimpleIndividual()
+    const double timeUnit = cConstant->canonical_units ? canonicalTime : 1;
+    const double mu = cConstant->canonical_units ? 1 : constG * massSun;
+    const double tripTime = threadRKParameters.tripTime / timeUnit;
+
+    elements<double> curPos = toTimeUnit(threadRKParameters.y0, timeUnit); // start with the initial conditions of the spacecraft
+    elements<double> nextPos, error;
+    stageCache<double> cache; // carries the last stage of each accepted step to the first of the next, unless carry_stage is false
+
+    double curTime = timeInitial / timeUnit;
+    double startTime = curTime;
+    double curAccel = 0;
+
+    // Same limits on the step size as rk4SimpleIndividual()
+    const double minStep = (tripTime - startTime) / cConstant->max_numsteps;
+    const double maxStep = (tripTime - startTime) / cConstant->min_numsteps;
+    double stepSize = fmin(fmax(startStepSize / timeUnit, minStep), maxStep);
+
+    // State of the PI controller, and the order of rk_tableau's error estimate it sizes steps by
+    double errPrev = 1e-4;
+    bool rejected = false;
+    const int errorOrder = tableauErrorOrder(cConstant->rk_tableau);
+
+    thruster<double> thrust(cConstant);
+
+    double massFuelSpent = 0; // mass of total fuel expended (kg) starts at 0
+    double stepFuelSpent;     // massFuelSpent if the step is accepted
+
+    // Times to check if the trajectory can still be a survivor, as in rk4SimpleIndividual()
+    individual.prunedTime = 0;
+    bool pruning = (prune != nullptr && prune->checkpoints > 0);
+    double pruneInterval = pruning ? (tripTime - startTime) / (prune->checkpoints + 1) : 0;
+    double nextPrune = startTime + pruneInterval;
+
+    while (curTime < tripTime) {
+        if ( (curTime + stepSize) > tripTime) {
+            stepSize = (tripTime - curTime); // shorten the last step to end exactly at time final
+        }
+
+        // Step size to go back to if this step is shortened to end at a thrust switch
+        double plannedStep = stepSize;
+
+        stepFuelSpent = massFuelSpent;
+        if (cConstant->thruster_type == thruster<double>::NO_THRUST) {
+            curAccel = 0;
+        }
+        else {
+            // End the step where the thrust switches, if it does during the step
+            bool coast = calc_coast(profile, curTime, tripTime, thrust);
+            if (calc_coast(profile, curTime + stepSize, tripTime, thrust) != coast) {
+                stepSize = coastSwitchTime(profile, curTime, curTime + stepSize, tripTime, thrust, coast) - curTime;
             }
-            
-            if ( (curTime + stepSize) > threadRKParameters.tripTime) {
-                stepSize = (threadRKParameters.tripTime - curTime); // shorten the last step to end exactly at time final
+            curAccel = calc_accel(curPos.r, curPos.z, thrust, stepFuelSpent, stepSize*timeUnit, coast, static_cast<double>(cConstant->wet_mass), cConstant) * timeUnit*timeUnit;
+        }
+
+        // Jump over the coast arc in closed form (keplerCoast() finds the switch itself), the loop continues from where the
+        // thrust comes back on or the trip ends
+        if (cConstant->kepler_coast && curAccel == 0) {
+            double arcStep = plannedStep;
+            if (keplerCoast(curTime, startTime, tripTime, arcStep, curPos, profile, thrust, massFuelSpent, cConstant, mu)) {
+                stepSize = arcStep;
+                continue;
             }
+        }
+
+        // calculate k values and get the value at the end of the step
+        nextPos = curPos;
+        rkCalc(curTime, tripTime, stepSize, nextPos, profile, curAccel, error, cConstant->rk_tableau, cConstant->carry_stage ? &cache : nullptr, static_cast<elements<double>*>(nullptr), mu);
+
+        double errNorm = calc_errorNorm(curPos, nextPos, error, absTol);
+        double newStep = calc_piStep(stepSize, errNorm, errPrev, rejected, errorOrder);
+
+        // Over the tolerance, try again from the same place with a smaller step
+        if (errNorm > 1 && stepSize > minStep) {
+            stepSize = fmax(newStep, minStep);
+            continue;
+        }
+
+        curPos = nextPos;
+        curTime += stepSize;
+        massFuelSpent = stepFuelSpent;
 
-            // if the spacecraft is within 0.5 au of the sun, the radial position of the spacecraft artificially increases to 1000, to force that path to not be used in the optimization.
-            if ( sqrt(pow(curPos.r,2) + pow(curPos.z,2)) < 0.5) {
-                //This is a bad result, needs to be set to be removed
-                // Right after callRK we check for NaN in the elements, then reset individual
-                individuals[threadId].finalPos.r = nan("");
+        // A step that was cut short at a thrust switch does not make the next one smaller
+        if (stepSize < plannedStep) {
+            newStep = fmax(newStep, plannedStep);
+        }
+        stepSize = fmin(fmax(newStep, minStep), maxStep);
 
-                //Just to make sure invalidating posDiff/velDiff
-                individuals[threadId].posDiff = nan("");
-                individuals[threadId].velDiff = nan("");            
+        // if the spacecraft is within 0.5 au of the sun, the trajectory is invalidated as in rk4SimpleIndividual()
+        if ( sqrt(pow(curPos.r,2) + pow(curPos.z,2)) < 0.5) {
+            individual.finalPos.r = nan("");
+            individual.posDiff = nan("");
+            individual.velDiff = nan("");
+            return;
+        }
 
+        // Stop here if no thrusting from this point on could make it a survivor
+        if (pruning && curTime >= nextPrune && curTime < tripTime) {
+            if (pruneTrajectory(individual, fromTimeUnit(curPos, timeUnit), (tripTime - curTime)*timeUnit, massFuelSpent, *prune, cConstant)) {
                 return;
             }
+            nextPrune += pruneInterval;
         }
+    }
 
-         // output to this thread's index
-        individuals[threadId].finalPos = curPos;
+    // output to this individual
+    individual.finalPos = fromTimeUnit(curPos, timeUnit);
 
-        // Calculate new values for this thread
-        individuals[threadId].getPosDiff(cConstant);
-        individuals[threadId].getVelDiff(cConstant);
-        individuals[threadId].getCost(cConstant);
+    // Calculate new values for this individual
+    individual.getPosDiff(cConstant);
+    individual.getVelDiff(cConstant);
+    individual.getCost(cConstant);
 
-        return;
-    }
     return;
 }
-
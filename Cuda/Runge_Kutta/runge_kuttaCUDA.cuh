@@ -3,13 +3,38 @@
 
 #include "../Thrust_FIles/calcFourier.h"
 #include "../Motion_Eqns/motion_equations.h" // Utility functions for calc_k()
+#include "pruning.h" // for pruneBounds and pruneTrajectory(), stopping trajectories that cannot be survivors
 
 // sets up parameters and allocates memory for and then calls rk4SimpleCUDA()
+// prune - cutoffs to stop trajectories early against, copied to the device, nullptr to integrate every trajectory to the end
 // Called by optimize() in optimization.cu
-void callRK(const int numThreads, const int blockThreads, Individual *generation, double timeInitial, double stepSize, double absTol, double & calcPerS, const cudaConstants* cConstant);
+void callRK(const int numThreads, const int blockThreads, Individual *generation, double timeInitial, double stepSize, double absTol, double & calcPerS, const cudaConstants* cConstant, const pruneBounds *prune = nullptr);
 
 // the simple version of the runge_kutta algorithm, on GPU
-__global__ void rk4SimpleCUDA(Individual *individuals, double *timeInitial, double *startStepSize, double *absTolInput, int n, const cudaConstants* cConstant);
+__global__ void rk4SimpleCUDA(Individual *individuals, double *timeInitial, double *startStepSize, double *absTolInput, int n, const cudaConstants* cConstant, const pruneBounds *prune);
+
+// Adaptive runge_kutta for one individual, the body of rk4SimpleCUDA()
+// Also called by the CPU backend (callRKCPU() in runge_kuttaCPU.cpp) so both backends integrate identically
+// Input: individual - startParams is used as the initial conditions
+//        timeInitial, startStepSize, absTol - same for every individual in a generation
+//        cConstant - step size limits and thruster information
+//        prune - if not nullptr, the trajectory is checked with pruneTrajectory() at prune->checkpoints evenly spaced times
+// Output: individual's finalPos, posDiff, velDiff, and cost are assigned, finalPos.r is NaN if the trajectory went within 0.5 AU of the sun
+//         if it was pruned, prunedTime is the time it had left and the results are pruneTrajectory()'s
+__host__ __device__ void rk4SimpleIndividual(Individual & individual, const double & timeInitial, const double & startStepSize, const double & absTol, const cudaConstants* cConstant, const pruneBounds *prune = nullptr);
+
+// Same as above with the thrust angles and coast state taken from profile instead of the individual's coefficients
+// profile is a coefficients<double> or a thrustTable<double> built from the individual's coefficients (used by the CPU backend when thrust_table_tol > 0)
+template <class P> __host__ __device__ void rk4SimpleIndividual(Individual & individual, P & profile, const double & timeInitial, const double & startStepSize, const double & absTol, const cudaConstants* cConstant, const pruneBounds *prune = nullptr);
+
+// rk4SimpleIndividual() with step_control=PI, which it calls in that case
+// Each step's error is measured with calc_errorNorm() against absTol, steps over it are retried with the smaller step from
+// calc_piStep() (unless already at tripTime/max_numsteps), and accepted steps size the next with calc_piStep()
+// A step that would cross a thrust switch is shortened to end on it (coastSwitchTime()), so the acceleration held through the step
+// is right for all of it, the step after continues with the size it had before being shortened
+// Fuel is only spent by steps that are accepted
+// Input and output: same as rk4SimpleIndividual()
+template <class P> __host__ __device__ void rk4ControlledIndividual(Individual & individual, P & profile, const double & timeInitial, const double & startStepSize, const double & absTol, const cudaConstants* cConstant, const pruneBounds *prune);
 
 
 #include "runge_kuttaCUDA.cu"
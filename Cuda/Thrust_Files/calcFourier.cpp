@@ -10,9 +10,23 @@ template <class T> __host__ __device__ T calc_Series(const T series[], const int
     T coeff = series[0];
     T curTimeRatio = curTime / timeFinal;
 
+    // cos(t) and sin(t) for the first harmonic, the rest are found with the angle addition formulas
+    //     cos((n+1)t) = cos(nt)cos(t) - sin(nt)sin(t)
+    //     sin((n+1)t) = sin(nt)cos(t) + cos(nt)sin(t)
+    // so only one cos and one sin are evaluated no matter how many terms the series has
+    T cos1 = cos(2*M_PI*curTimeRatio);
+    T sin1 = sin(2*M_PI*curTimeRatio);
+    T cosN = cos1;
+    T sinN = sin1;
+    T cosNext;
+
     // f(x) = a_0 + sum{a_n*cos(n*t)+b_n*sin(n*t)}
     for (int i = 1; i <= (series_size-1)/2; i++) {
-        coeff += series[2*i-1]*cos(2*M_PI*i*curTimeRatio)+series[2*i]*sin(2*M_PI*i*curTimeRatio);
+        coeff += series[2*i-1]*cosN + series[2*i]*sinN;
+
+        cosNext = cosN*cos1 - sinN*sin1;
+        sinN = sinN*cos1 + cosN*sin1;
+        cosN = cosNext;
     }
     return coeff;
 }
@@ -25,6 +39,18 @@ template <class T> __host__ __device__ T calc_tau(coefficients<T> & coeff, const
     return calc_Series(coeff.tau, coeff.tauSize, curTime, timeFinal);
 }
 
+template <class T> __host__ __device__ thrustAngles<T> calc_thrustAngles(coefficients<T> & coeff, const T & curTime, const T & timeFinal) {
+    T gamma = calc_gamma(coeff, curTime, timeFinal);
+    T tau = calc_tau(coeff, curTime, timeFinal);
+
+    thrustAngles<T> angles;
+    angles.sinGamma = sin(gamma);
+    angles.cosGamma = cos(gamma);
+    angles.sinTau = sin(tau);
+    angles.cosTau = cos(tau);
+    return angles;
+}
+
 template <class T> __host__ __device__ bool calc_coast(coefficients<T> & coeff, const T & curTime, const T & timeFinal, thruster<T> & thrust) {
     // Use the fourier series for the coasting coefficients, then take the sin^2(coasting)
     T coastValue = pow( sin(calc_Series(coeff.coast, coeff.coastSize, curTime, timeFinal)), 2);
@@ -8,6 +8,7 @@
 //         curTime: current time (s) for calculated gamma
 //         timeFinal: end time (s), used to normalize t
 // output: the value of the fourier series evaluated at a curTime
+// Only the first harmonic calls cos and sin, higher harmonics are found by recurrence (angle addition)
 template <class T> __host__ __device__ T calc_Series(const T series[], const int series_size, const T & curTime, const T & timeFinal);
 
 // Calculates gamma (in-plane angle) at a specific time using Fourier series coefficients
@@ -31,6 +32,21 @@ template <class T> __host__ __device__ T calc_gamma(const coefficients<T> & coef
 // output: in-plane angle derived from normalized time and tau Fourier series
 template <class T> __host__ __device__ T calc_tau(const coefficients<T> & coeff,const T & curTime, const T & timeFinal);
 
+// Sines and cosines of the thrust angles at one time, which is all the equations of motion need from gamma and tau
+// Evaluated once per runge kutta stage by calc_thrustAngles() and shared by calcRate_vr(), calcRate_vtheta(), and calcRate_vz()
+template <class T> struct thrustAngles {
+    T sinGamma, cosGamma; // in-plane angle
+    T sinTau, cosTau;     // out-of-plane angle
+};
+
+// Calculates the sines and cosines of gamma and tau at a specific time
+// Parameters:
+//         coeff: coefficients structure, the gamma and tau components are used
+//         curTime: current time (s)
+//         timeFinal: end time (s), used to normalize t
+// output: thrustAngles at curTime
+template <class T> __host__ __device__ thrustAngles<T> calc_thrustAngles(coefficients<T> & coeff, const T & curTime, const T & timeFinal);
+
 // Evaluates whether the spacecraft is accelerating or coasting for a specific iteration
 // Parameters:
 //         coeff: coefficients structure, specifically the tau components
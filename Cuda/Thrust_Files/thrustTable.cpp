@@ -0,0 +1,129 @@
+#include <math.h> // for sin, cos, and fabs
+
+template <class T> void calc_SeriesSlope(const T series[], const int series_size, const T & x, T & value, T & slope) {
+    // Same recurrence as calc_Series()
+    T cos1 = cos(2*M_PI*x);
+    T sin1 = sin(2*M_PI*x);
+    T cosN = cos1;
+    T sinN = sin1;
+    T cosNext;
+
+    value = series[0];
+    slope = 0;
+    // f(x) = a_0 + sum{a_n*cos(2pi*n*x)+b_n*sin(2pi*n*x)}
+    // f'(x) = sum{2pi*n*(b_n*cos(2pi*n*x)-a_n*sin(2pi*n*x))}
+    for (int i = 1; i <= (series_size-1)/2; i++) {
+        value += series[2*i-1]*cosN + series[2*i]*sinN;
+        slope += 2*M_PI*i*(series[2*i]*cosN - series[2*i-1]*sinN);
+
+        cosNext = cosN*cos1 - sinN*sin1;
+        sinN = sinN*cos1 + cosN*sin1;
+        cosN = cosNext;
+    }
+}
+
+// Evaluates every quantity of the table, and its slope, from the Fourier series at normalized time x
+template <class T> void calc_TableValues(coefficients<T> & coeff, const T & x, T value[], T slope[]) {
+    T gamma, gammaSlope, tau, tauSlope, coast, coastSlope;
+    calc_SeriesSlope(coeff.gamma, coeff.gammaSize, x, gamma, gammaSlope);
+    calc_SeriesSlope(coeff.tau, coeff.tauSize, x, tau, tauSlope);
+    calc_SeriesSlope(coeff.coast, coeff.coastSize, x, coast, coastSlope);
+
+    value[TABLE_SIN_GAMMA] = sin(gamma);
+    value[TABLE_COS_GAMMA] = cos(gamma);
+    value[TABLE_SIN_TAU] = sin(tau);
+    value[TABLE_COS_TAU] = cos(tau);
+    value[TABLE_COAST] = pow(sin(coast), 2);
+
+    slope[TABLE_SIN_GAMMA] = value[TABLE_COS_GAMMA]*gammaSlope;
+    slope[TABLE_COS_GAMMA] = -value[TABLE_SIN_GAMMA]*gammaSlope;
+    slope[TABLE_SIN_TAU] = value[TABLE_COS_TAU]*tauSlope;
+    slope[TABLE_COS_TAU] = -value[TABLE_SIN_TAU]*tauSlope;
+    slope[TABLE_COAST] = sin(2*coast)*coastSlope; // d/dx sin^2(c) = 2sin(c)cos(c)c'
+}
+
+template <class T> bool initThrustTable(thrustTable<T> & table, coefficients<T> & coeff, const T & tolerance) {
+    table.nodes = THRUST_TABLE_MIN_NODES;
+    table.spacing = 1.0 / (table.nodes-1);
+    for (int i = 0; i < table.nodes; i++) {
+        calc_TableValues(coeff, i*table.spacing, table.value[i], table.slope[i]);
+    }
+
+    while (2*(table.nodes-1)+1 <= THRUST_TABLE_MAX_NODES) {
+        // Spread the current points out to every other slot, top down so none are overwritten
+        for (int i = table.nodes-1; i > 0; i--) {
+            for (int j = 0; j < TABLE_VALUES; j++) {
+                table.value[2*i][j] = table.value[i][j];
+                table.slope[2*i][j] = table.slope[i][j];
+            }
+        }
+        T width = table.spacing; // width of the intervals being checked
+        table.nodes = 2*(table.nodes-1)+1;
+        table.spacing = width / 2;
+
+        // Fill in the middles, checking the Hermite interpolation of the wider intervals against them
+        // At the middle of an interval the cubic Hermite value is (y0+y1)/2 + width*(m0-m1)/8
+        T maxError = 0;
+        for (int i = 1; i < table.nodes; i += 2) {
+            calc_TableValues(coeff, i*table.spacing, table.value[i], table.slope[i]);
+            for (int j = 0; j < TABLE_VALUES; j++) {
+                T estimate = (table.value[i-1][j] + table.value[i+1][j])/2 + width*(table.slope[i-1][j] - table.slope[i+1][j])/8;
+                maxError = fmax(maxError, fabs(estimate - table.value[i][j]));
+            }
+        }
+
+        // The wider grid met the tolerance, so the grid with the middles filled in (which is used) does too
+        if (maxError <= tolerance) {
+            return true;
+        }
+
+        // The cubic Hermite error falls about 16 times each time the intervals are halved, so give up without building the
+        // finer grids when even the finest would be over the tolerance by more than THRUST_TABLE_GIVE_UP
+        T reachable = maxError;
+        for (int n = 2*(table.nodes-1)+1; n <= THRUST_TABLE_MAX_NODES; n = 2*(n-1)+1) {
+            reachable /= 16;
+        }
+        if (reachable > THRUST_TABLE_GIVE_UP * tolerance) {
+            return false;
+        }
+    }
+    return false;
+}
+
+template <class T> T interpolateTable(const thrustTable<T> & table, const int & j, const T & x) {
+    // Interval holding x, clamped so x = 1 uses the last interval
+    int i = static_cast<int>(x / table.spacing);
+    if (i > table.nodes-2) {
+        i = table.nodes-2;
+    }
+    else if (i < 0) {
+        i = 0;
+    }
+
+    // Position within the interval (0 to 1) and the Hermite basis functions
+    T u = x / table.spacing - i;
+    T u2 = u*u;
+    T u3 = u2*u;
+    T h00 = 2*u3 - 3*u2 + 1;
+    T h10 = u3 - 2*u2 + u;
+    T h01 = -2*u3 + 3*u2;
+    T h11 = u3 - u2;
+
+    return h00*table.value[i][j] + h10*table.spacing*table.slope[i][j] + h01*table.value[i+1][j] + h11*table.spacing*table.slope[i+1][j];
+}
+
+template <class T> thrustAngles<T> calc_thrustAngles(const thrustTable<T> & table, const T & curTime, const T & timeFinal) {
+    T x = curTime / timeFinal;
+
+    thrustAngles<T> angles;
+    angles.sinGamma = interpolateTable(table, TABLE_SIN_GAMMA, x);
+    angles.cosGamma = interpolateTable(table, TABLE_COS_GAMMA, x);
+    angles.sinTau = interpolateTable(table, TABLE_SIN_TAU, x);
+    angles.cosTau = interpolateTable(table, TABLE_COS_TAU, x);
+    return angles;
+}
+
+template <class T> bool calc_coast(const thrustTable<T> & table, const T & curTime, const T & timeFinal, thruster<T> & thrust) {
+    // if it is above the optimized threshold we return true for not coasting, same as calc_coast() with coefficients
+    return interpolateTable(table, TABLE_COAST, curTime / timeFinal) >= thrust.coastThreshold;
+}
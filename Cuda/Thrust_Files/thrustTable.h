@@ -0,0 +1,55 @@
+#ifndef THRUSTTABLE_H
+#define THRUSTTABLE_H
+
+// Most grid points a thrustTable can hold, 1024 intervals over the trip
+// At 80 bytes per point a full table is about 80 KB. Tables are built when an individual is evaluated rather than kept for
+// the whole population, so only the tables being integrated (one per CPU thread, or one per lane in rk4SimpleBatch()) need to stay in L2
+#define THRUST_TABLE_MAX_NODES 1025
+
+// Grid points used to start with, the number of intervals is doubled from here until the tolerance is met
+#define THRUST_TABLE_MIN_NODES 9
+
+// How far over the tolerance the finest grid can be estimated to be before initThrustTable() gives up early
+// The estimate assumes the interpolation error falls 16 times each time the intervals are halved. It can fall faster while
+// the grid is still too coarse to follow the series, so this leaves room for that
+#define THRUST_TABLE_GIVE_UP 4
+
+// Quantities held at each grid point
+enum THRUST_TABLE_VALUES { TABLE_SIN_GAMMA = 0, TABLE_COS_GAMMA, TABLE_SIN_TAU, TABLE_COS_TAU, TABLE_COAST, TABLE_VALUES };
+
+// Thrust profile of one individual sampled on an even grid of normalized time (curTime/tripTime from 0 to 1)
+// Holds sin/cos of gamma and tau and the coast value (sin^2 of the coast series) with their slopes at each grid point,
+// so in between points they are found with cubic Hermite interpolation instead of evaluating the Fourier series and trig functions
+// Used in place of coefficients<T> by calc_thrustAngles() and calc_coast()
+template <class T> struct thrustTable {
+    int nodes;    // number of grid points in use
+    T spacing;    // distance between grid points in normalized time, 1/(nodes-1)
+
+    // value[i][j] and slope[i][j] are quantity j (THRUST_TABLE_VALUES) at grid point i, slope is with respect to normalized time
+    T value[THRUST_TABLE_MAX_NODES][TABLE_VALUES];
+    T slope[THRUST_TABLE_MAX_NODES][TABLE_VALUES];
+};
+
+// Fills a thrustTable from an individual's coefficients
+// Starts with THRUST_TABLE_MIN_NODES points and doubles the number of intervals until the interpolated values are within tolerance
+// of the Fourier series at the middle of every interval (where the cubic Hermite error peaks)
+// The middles checked become the new grid points, so the series are evaluated once per grid point of the finished table
+// Input: coeff - coefficients of the individual
+//        tolerance - largest allowed difference between an interpolated and evaluated value (thrust_table_tol in the config)
+// Output: table is filled, returns false if the tolerance could not be met with THRUST_TABLE_MAX_NODES points,
+//         in which case the Fourier series should be used for this individual instead
+template <class T> bool initThrustTable(thrustTable<T> & table, coefficients<T> & coeff, const T & tolerance);
+
+// Value and slope (with respect to normalized time) of a Fourier series at normalized time x, see calc_Series() for the series
+template <class T> void calc_SeriesSlope(const T series[], const int series_size, const T & x, T & value, T & slope);
+
+// Cubic Hermite interpolation of quantity j of the table at normalized time x
+template <class T> T interpolateTable(const thrustTable<T> & table, const int & j, const T & x);
+
+// thrustTable versions of calc_thrustAngles() and calc_coast(), interpolating in place of evaluating the Fourier series
+// The coast state can differ from calc_coast() only where the coast value is within the table tolerance of the threshold
+template <class T> thrustAngles<T> calc_thrustAngles(const thrustTable<T> & table, const T & curTime, const T & timeFinal);
+template <class T> bool calc_coast(const thrustTable<T> & table, const T & curTime, const T & timeFinal, thruster<T> & thrust);
+
+#include "thrustTable.cpp"
+#endif